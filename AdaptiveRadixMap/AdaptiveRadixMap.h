@@ -0,0 +1,1065 @@
+#pragma once
+#include <string>
+#include <stack>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ADAPTIVE_RADIX_MAP_SSE2
+#endif
+
+// Turns a key into the byte string the tree is indexed by. The byte order of two
+// encodings must match the order of the keys they come from.
+template <class Key, class Enable = void>
+struct RadixKeyTraits;
+
+// Integers are stored big-endian with the sign bit flipped, so that comparing
+// the bytes left to right gives the numeric order.
+template <class Key>
+struct RadixKeyTraits<Key, typename std::enable_if<std::is_integral<Key>::value>::type>
+{
+	class Encoded
+	{
+	private:
+		uint8_t bytes[sizeof(Key)];
+
+	public:
+		explicit Encoded(const Key& k)
+		{
+			typedef typename std::make_unsigned<Key>::type Unsigned;
+			Unsigned u = (Unsigned)k;
+			if (std::is_signed<Key>::value)
+				u ^= (Unsigned)1 << (sizeof(Key) * 8 - 1);
+
+			for (size_t i = 0; i < sizeof(Key); ++i)
+				bytes[i] = (uint8_t)(u >> (8 * (sizeof(Key) - 1 - i)));
+		}
+
+		const uint8_t* data() const { return bytes; }
+		size_t size() const { return sizeof(Key); }
+	};
+};
+
+template <>
+struct RadixKeyTraits<std::string>
+{
+	class Encoded
+	{
+	private:
+		const std::string& str;
+
+	public:
+		explicit Encoded(const std::string& k) : str(k) {}
+
+		const uint8_t* data() const { return (const uint8_t*)str.data(); }
+		size_t size() const { return str.size(); }
+	};
+};
+
+// Adaptive radix tree (Leis et al.). Inner nodes grow from 4 to 16, 48 and 256
+// children as needed, chains of single-child nodes are collapsed into a prefix
+// stored in the node, and a key that is alone in its subtree is stored as a leaf
+// directly below the first byte that distinguishes it.
+template <class Key, class Value, class Traits = RadixKeyTraits<Key>>
+class AdaptiveRadixMap
+{
+private:
+	static const size_t MAX_PREFIX = 8;
+
+	enum class NodeType : uint8_t { Leaf, Node4, Node16, Node48, Node256 };
+
+	struct Node
+	{
+		NodeType type;
+
+		explicit Node(NodeType type) : type(type) {}
+	};
+
+	struct Leaf : Node
+	{
+		std::pair<Key, Value> data;
+
+		explicit Leaf(const std::pair<Key, Value>& data) : Node(NodeType::Leaf), data(data) {}
+	};
+
+	struct Inner : Node
+	{
+		uint8_t prefixLen = 0;
+		uint8_t prefix[MAX_PREFIX];
+		uint16_t count = 0;
+		Leaf* terminal = nullptr; // key that ends right after the prefix
+
+		explicit Inner(NodeType type) : Node(type) {}
+	};
+
+	struct Node4 : Inner
+	{
+		uint8_t keys[4];
+		Node* children[4];
+
+		Node4() : Inner(NodeType::Node4) {}
+	};
+
+	struct Node16 : Inner
+	{
+		uint8_t keys[16];
+		Node* children[16];
+
+		Node16() : Inner(NodeType::Node16) {}
+	};
+
+	struct Node48 : Inner
+	{
+		uint8_t childIndex[256]; // 0 means no child, otherwise slot + 1
+		Node* children[48];
+
+		Node48() : Inner(NodeType::Node48) { std::memset(childIndex, 0, sizeof(childIndex)); }
+	};
+
+	struct Node256 : Inner
+	{
+		Node* children[256];
+
+		Node256() : Inner(NodeType::Node256) { std::memset(children, 0, sizeof(children)); }
+	};
+
+	Node* root;
+	size_t sz;
+
+	static bool isLeaf(const Node* node);
+	static bool leafMatches(const Leaf* leaf, const typename Traits::Encoded& key);
+	static size_t prefixMismatch(const Inner* node, const typename Traits::Encoded& key, size_t depth);
+
+	static Node** findChild(Inner* node, uint8_t byte);
+	static Node* childAt(const Inner* node, int& position);
+	static void addChild(Node** ref, uint8_t byte, Node* child);
+	static void removeChild(Node** ref, uint8_t byte);
+	static void shrink(Node** ref);
+	static void copyHeader(Inner* to, const Inner* from);
+
+	Inner* makePath(Node** ref, const typename Traits::Encoded& key, size_t depth, size_t length);
+	bool remove(Node** ref, const typename Traits::Encoded& key, size_t depth);
+	const Leaf* findLeaf(const Key& k) const;
+
+	static void free(Node* node);
+	static Node* copy(const Node* node);
+
+public:
+	AdaptiveRadixMap();
+	AdaptiveRadixMap(const AdaptiveRadixMap& other);
+	AdaptiveRadixMap& operator=(const AdaptiveRadixMap& other);
+	~AdaptiveRadixMap();
+
+	bool insert(const std::pair<Key, Value>& newData);
+	bool insert(const Key& k, const Value& v);
+	bool containsKey(const Key& k) const;
+	const Value* find(const Key& k) const;
+	bool remove(const Key& k);
+	size_t size() const;
+	bool empty() const;
+
+	// Calls fn(pair) in key order for every key whose encoding starts with the
+	// encoding of prefix.
+	template <class Function>
+	void forEachWithPrefix(const Key& prefix, Function fn) const;
+
+	class ConstIterator
+	{
+	private:
+		struct Frame
+		{
+			const Inner* node;
+			int position; // -1 before the terminal leaf has been visited
+		};
+
+		std::stack<Frame> frames;
+		const Leaf* current;
+
+		void descend(const Node* node);
+		void advance();
+
+	public:
+		ConstIterator(const Node* root = nullptr);
+		const std::pair<Key, Value>& operator*() const;
+		ConstIterator& operator++();
+		ConstIterator operator++(int);
+		bool operator==(const ConstIterator& other) const;
+		bool operator!=(const ConstIterator& other) const;
+	};
+
+	ConstIterator cbegin() const;
+	ConstIterator cend() const;
+};
+
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::isLeaf(const Node* node)
+{
+	return node->type == NodeType::Leaf;
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::leafMatches(const Leaf* leaf, const typename Traits::Encoded& key)
+{
+	typename Traits::Encoded leafKey(leaf->data.first);
+	return leafKey.size() == key.size() && std::memcmp(leafKey.data(), key.data(), key.size()) == 0;
+}
+
+// Number of prefix bytes of node that match key from depth on.
+template <class Key, class Value, class Traits>
+size_t AdaptiveRadixMap<Key, Value, Traits>::prefixMismatch(const Inner* node, const typename Traits::Encoded& key, size_t depth)
+{
+	size_t i = 0;
+	while (i < node->prefixLen && depth + i < key.size() && node->prefix[i] == key.data()[depth + i])
+		++i;
+	return i;
+}
+
+template <class Key, class Value, class Traits>
+typename AdaptiveRadixMap<Key, Value, Traits>::Node** AdaptiveRadixMap<Key, Value, Traits>::findChild(Inner* node, uint8_t byte)
+{
+	switch (node->type)
+	{
+	case NodeType::Node4:
+	{
+		Node4* n = static_cast<Node4*>(node);
+		for (size_t i = 0; i < n->count; ++i)
+			if (n->keys[i] == byte)
+				return &n->children[i];
+		return nullptr;
+	}
+	case NodeType::Node16:
+	{
+		Node16* n = static_cast<Node16*>(node);
+#ifdef ADAPTIVE_RADIX_MAP_SSE2
+		__m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte), _mm_loadu_si128((const __m128i*)n->keys));
+		unsigned mask = (unsigned)_mm_movemask_epi8(cmp) & ((1u << n->count) - 1);
+		if (!mask)
+			return nullptr;
+		size_t i = 0;
+		while (!(mask & 1))
+		{
+			mask >>= 1;
+			++i;
+		}
+		return &n->children[i];
+#else
+		for (size_t i = 0; i < n->count; ++i)
+			if (n->keys[i] == byte)
+				return &n->children[i];
+		return nullptr;
+#endif
+	}
+	case NodeType::Node48:
+	{
+		Node48* n = static_cast<Node48*>(node);
+		return n->childIndex[byte] ? &n->children[n->childIndex[byte] - 1] : nullptr;
+	}
+	case NodeType::Node256:
+	{
+		Node256* n = static_cast<Node256*>(node);
+		return n->children[byte] ? &n->children[byte] : nullptr;
+	}
+	default:
+		return nullptr;
+	}
+}
+
+// Returns the first child at or after position in byte order and moves position
+// past it, or nullptr when there are no more children.
+template <class Key, class Value, class Traits>
+typename AdaptiveRadixMap<Key, Value, Traits>::Node* AdaptiveRadixMap<Key, Value, Traits>::childAt(const Inner* node, int& position)
+{
+	switch (node->type)
+	{
+	case NodeType::Node4:
+	{
+		const Node4* n = static_cast<const Node4*>(node);
+		return position < n->count ? n->children[position++] : nullptr;
+	}
+	case NodeType::Node16:
+	{
+		const Node16* n = static_cast<const Node16*>(node);
+		return position < n->count ? n->children[position++] : nullptr;
+	}
+	case NodeType::Node48:
+	{
+		const Node48* n = static_cast<const Node48*>(node);
+		for (; position < 256; ++position)
+			if (n->childIndex[position])
+				return n->children[n->childIndex[position++] - 1];
+		return nullptr;
+	}
+	case NodeType::Node256:
+	{
+		const Node256* n = static_cast<const Node256*>(node);
+		for (; position < 256; ++position)
+			if (n->children[position])
+				return n->children[position++];
+		return nullptr;
+	}
+	default:
+		return nullptr;
+	}
+}
+
+template <class Key, class Value, class Traits>
+void AdaptiveRadixMap<Key, Value, Traits>::copyHeader(Inner* to, const Inner* from)
+{
+	to->prefixLen = from->prefixLen;
+	std::memcpy(to->prefix, from->prefix, from->prefixLen);
+	to->terminal = from->terminal;
+}
+
+// Adds a child to the inner node *ref, replacing it with the next bigger node
+// type when it is full.
+template <class Key, class Value, class Traits>
+void AdaptiveRadixMap<Key, Value, Traits>::addChild(Node** ref, uint8_t byte, Node* child)
+{
+	Inner* node = static_cast<Inner*>(*ref);
+
+	switch (node->type)
+	{
+	case NodeType::Node4:
+	{
+		Node4* n = static_cast<Node4*>(node);
+		if (n->count < 4)
+		{
+			size_t i = n->count;
+			for (; i > 0 && n->keys[i - 1] > byte; --i)
+			{
+				n->keys[i] = n->keys[i - 1];
+				n->children[i] = n->children[i - 1];
+			}
+			n->keys[i] = byte;
+			n->children[i] = child;
+			n->count++;
+			return;
+		}
+
+		Node16* grown = new Node16();
+		copyHeader(grown, n);
+		std::memcpy(grown->keys, n->keys, 4);
+		std::memcpy(grown->children, n->children, 4 * sizeof(Node*));
+		grown->count = 4;
+		*ref = grown;
+		delete n;
+		addChild(ref, byte, child);
+		return;
+	}
+	case NodeType::Node16:
+	{
+		Node16* n = static_cast<Node16*>(node);
+		if (n->count < 16)
+		{
+			size_t i = n->count;
+			for (; i > 0 && n->keys[i - 1] > byte; --i)
+			{
+				n->keys[i] = n->keys[i - 1];
+				n->children[i] = n->children[i - 1];
+			}
+			n->keys[i] = byte;
+			n->children[i] = child;
+			n->count++;
+			return;
+		}
+
+		Node48* grown = new Node48();
+		copyHeader(grown, n);
+		for (size_t i = 0; i < 16; ++i)
+		{
+			grown->childIndex[n->keys[i]] = (uint8_t)(i + 1);
+			grown->children[i] = n->children[i];
+		}
+		grown->count = 16;
+		*ref = grown;
+		delete n;
+		addChild(ref, byte, child);
+		return;
+	}
+	case NodeType::Node48:
+	{
+		Node48* n = static_cast<Node48*>(node);
+		if (n->count < 48)
+		{
+			// Slots are kept dense by removeChild, so the first free one is count.
+			n->children[n->count] = child;
+			n->childIndex[byte] = (uint8_t)(n->count + 1);
+			n->count++;
+			return;
+		}
+
+		Node256* grown = new Node256();
+		copyHeader(grown, n);
+		for (size_t b = 0; b < 256; ++b)
+			if (n->childIndex[b])
+				grown->children[b] = n->children[n->childIndex[b] - 1];
+		grown->count = 48;
+		*ref = grown;
+		delete n;
+		addChild(ref, byte, child);
+		return;
+	}
+	case NodeType::Node256:
+	{
+		Node256* n = static_cast<Node256*>(node);
+		n->children[byte] = child;
+		n->count++;
+		return;
+	}
+	default:
+		return;
+	}
+}
+
+template <class Key, class Value, class Traits>
+void AdaptiveRadixMap<Key, Value, Traits>::removeChild(Node** ref, uint8_t byte)
+{
+	Inner* node = static_cast<Inner*>(*ref);
+
+	switch (node->type)
+	{
+	case NodeType::Node4:
+	case NodeType::Node16:
+	{
+		uint8_t* keys = node->type == NodeType::Node4 ? static_cast<Node4*>(node)->keys : static_cast<Node16*>(node)->keys;
+		Node** children = node->type == NodeType::Node4 ? static_cast<Node4*>(node)->children : static_cast<Node16*>(node)->children;
+
+		size_t i = 0;
+		while (keys[i] != byte)
+			++i;
+		for (; i + 1 < node->count; ++i)
+		{
+			keys[i] = keys[i + 1];
+			children[i] = children[i + 1];
+		}
+		node->count--;
+		break;
+	}
+	case NodeType::Node48:
+	{
+		Node48* n = static_cast<Node48*>(node);
+		size_t slot = n->childIndex[byte] - 1;
+		size_t last = n->count - 1;
+		if (slot != last)
+		{
+			for (size_t b = 0; b < 256; ++b)
+			{
+				if (n->childIndex[b] == last + 1)
+				{
+					n->childIndex[b] = (uint8_t)(slot + 1);
+					break;
+				}
+			}
+			n->children[slot] = n->children[last];
+		}
+		n->childIndex[byte] = 0;
+		n->count--;
+		break;
+	}
+	case NodeType::Node256:
+	{
+		Node256* n = static_cast<Node256*>(node);
+		n->children[byte] = nullptr;
+		n->count--;
+		break;
+	}
+	default:
+		break;
+	}
+
+	shrink(ref);
+}
+
+// Replaces *ref with a smaller node type once it is sparse enough, or removes
+// it entirely when it no longer branches.
+template <class Key, class Value, class Traits>
+void AdaptiveRadixMap<Key, Value, Traits>::shrink(Node** ref)
+{
+	Inner* node = static_cast<Inner*>(*ref);
+
+	if (node->count == 0)
+	{
+		*ref = node->terminal;
+		node->terminal = nullptr;
+		free(node);
+		return;
+	}
+
+	switch (node->type)
+	{
+	case NodeType::Node4:
+	{
+		Node4* n = static_cast<Node4*>(node);
+		if (n->count != 1 || n->terminal)
+			return;
+
+		Node* child = n->children[0];
+		if (isLeaf(child))
+		{
+			*ref = child;
+			delete n;
+			return;
+		}
+
+		Inner* inner = static_cast<Inner*>(child);
+		if ((size_t)n->prefixLen + 1 + inner->prefixLen > MAX_PREFIX)
+			return;
+
+		uint8_t merged[MAX_PREFIX];
+		std::memcpy(merged, n->prefix, n->prefixLen);
+		merged[n->prefixLen] = n->keys[0];
+		std::memcpy(merged + n->prefixLen + 1, inner->prefix, inner->prefixLen);
+		inner->prefixLen = (uint8_t)(n->prefixLen + 1 + inner->prefixLen);
+		std::memcpy(inner->prefix, merged, inner->prefixLen);
+
+		*ref = inner;
+		delete n;
+		return;
+	}
+	case NodeType::Node16:
+	{
+		Node16* n = static_cast<Node16*>(node);
+		if (n->count > 3)
+			return;
+
+		Node4* shrunk = new Node4();
+		copyHeader(shrunk, n);
+		std::memcpy(shrunk->keys, n->keys, n->count);
+		std::memcpy(shrunk->children, n->children, n->count * sizeof(Node*));
+		shrunk->count = n->count;
+		*ref = shrunk;
+		delete n;
+		shrink(ref);
+		return;
+	}
+	case NodeType::Node48:
+	{
+		Node48* n = static_cast<Node48*>(node);
+		if (n->count > 12)
+			return;
+
+		Node16* shrunk = new Node16();
+		copyHeader(shrunk, n);
+		for (size_t b = 0; b < 256; ++b)
+		{
+			if (n->childIndex[b])
+			{
+				shrunk->keys[shrunk->count] = (uint8_t)b;
+				shrunk->children[shrunk->count++] = n->children[n->childIndex[b] - 1];
+			}
+		}
+		*ref = shrunk;
+		delete n;
+		return;
+	}
+	case NodeType::Node256:
+	{
+		Node256* n = static_cast<Node256*>(node);
+		if (n->count > 37)
+			return;
+
+		Node48* shrunk = new Node48();
+		copyHeader(shrunk, n);
+		for (size_t b = 0; b < 256; ++b)
+		{
+			if (n->children[b])
+			{
+				shrunk->children[shrunk->count] = n->children[b];
+				shrunk->childIndex[b] = (uint8_t)++shrunk->count;
+			}
+		}
+		*ref = shrunk;
+		delete n;
+		return;
+	}
+	default:
+		return;
+	}
+}
+
+// Creates a chain of Node4s that consumes key[depth, depth + length) and
+// returns the last one. A single node can hold MAX_PREFIX bytes, so longer
+// shared prefixes take several.
+template <class Key, class Value, class Traits>
+typename AdaptiveRadixMap<Key, Value, Traits>::Inner* AdaptiveRadixMap<Key, Value, Traits>::makePath(Node** ref, const typename Traits::Encoded& key, size_t depth, size_t length)
+{
+	while (true)
+	{
+		Node4* node = new Node4();
+		size_t take = length < MAX_PREFIX ? length : MAX_PREFIX;
+		std::memcpy(node->prefix, key.data() + depth, take);
+		node->prefixLen = (uint8_t)take;
+		*ref = node;
+
+		depth += take;
+		length -= take;
+		if (length == 0)
+			return node;
+
+		node->keys[0] = key.data()[depth];
+		node->count = 1;
+		ref = &node->children[0];
+		++depth;
+		--length;
+	}
+}
+
+template <class Key, class Value, class Traits>
+void AdaptiveRadixMap<Key, Value, Traits>::free(Node* node)
+{
+	if (!node)
+		return;
+
+	if (isLeaf(node))
+	{
+		delete static_cast<Leaf*>(node);
+		return;
+	}
+
+	Inner* inner = static_cast<Inner*>(node);
+	free(inner->terminal);
+
+	int position = 0;
+	while (Node* child = childAt(inner, position))
+		free(child);
+
+	switch (node->type)
+	{
+	case NodeType::Node4: delete static_cast<Node4*>(node); break;
+	case NodeType::Node16: delete static_cast<Node16*>(node); break;
+	case NodeType::Node48: delete static_cast<Node48*>(node); break;
+	case NodeType::Node256: delete static_cast<Node256*>(node); break;
+	default: break;
+	}
+}
+
+template <class Key, class Value, class Traits>
+typename AdaptiveRadixMap<Key, Value, Traits>::Node* AdaptiveRadixMap<Key, Value, Traits>::copy(const Node* node)
+{
+	if (!node)
+		return nullptr;
+
+	switch (node->type)
+	{
+	case NodeType::Leaf:
+		return new Leaf(static_cast<const Leaf*>(node)->data);
+	case NodeType::Node4:
+	{
+		Node4* n = new Node4(*static_cast<const Node4*>(node));
+		for (size_t i = 0; i < n->count; ++i)
+			n->children[i] = copy(n->children[i]);
+		n->terminal = static_cast<Leaf*>(copy(n->terminal));
+		return n;
+	}
+	case NodeType::Node16:
+	{
+		Node16* n = new Node16(*static_cast<const Node16*>(node));
+		for (size_t i = 0; i < n->count; ++i)
+			n->children[i] = copy(n->children[i]);
+		n->terminal = static_cast<Leaf*>(copy(n->terminal));
+		return n;
+	}
+	case NodeType::Node48:
+	{
+		Node48* n = new Node48(*static_cast<const Node48*>(node));
+		for (size_t i = 0; i < n->count; ++i)
+			n->children[i] = copy(n->children[i]);
+		n->terminal = static_cast<Leaf*>(copy(n->terminal));
+		return n;
+	}
+	case NodeType::Node256:
+	{
+		Node256* n = new Node256(*static_cast<const Node256*>(node));
+		for (size_t b = 0; b < 256; ++b)
+			n->children[b] = copy(n->children[b]);
+		n->terminal = static_cast<Leaf*>(copy(n->terminal));
+		return n;
+	}
+	default:
+		return nullptr;
+	}
+}
+
+template <class Key, class Value, class Traits>
+AdaptiveRadixMap<Key, Value, Traits>::AdaptiveRadixMap() : root(nullptr), sz(0) {}
+
+template <class Key, class Value, class Traits>
+AdaptiveRadixMap<Key, Value, Traits>::AdaptiveRadixMap(const AdaptiveRadixMap& other) : root(copy(other.root)), sz(other.sz) {}
+
+template <class Key, class Value, class Traits>
+AdaptiveRadixMap<Key, Value, Traits>& AdaptiveRadixMap<Key, Value, Traits>::operator=(const AdaptiveRadixMap& other)
+{
+	if (this != &other)
+	{
+		free(root);
+		root = copy(other.root);
+		sz = other.sz;
+	}
+	return *this;
+}
+
+template <class Key, class Value, class Traits>
+AdaptiveRadixMap<Key, Value, Traits>::~AdaptiveRadixMap()
+{
+	free(root);
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::insert(const std::pair<Key, Value>& newData)
+{
+	typename Traits::Encoded key(newData.first);
+	Node** current = &root;
+	size_t depth = 0;
+
+	while (*current)
+	{
+		if (isLeaf(*current))
+		{
+			Leaf* existing = static_cast<Leaf*>(*current);
+			if (leafMatches(existing, key))
+				return false;
+
+			// Lazy expansion: the two keys get an inner node only now, at the
+			// first byte where they differ.
+			typename Traits::Encoded existingKey(existing->data.first);
+			size_t common = 0;
+			while (depth + common < key.size() && depth + common < existingKey.size()
+				&& key.data()[depth + common] == existingKey.data()[depth + common])
+				++common;
+
+			Inner* split = makePath(current, key, depth, common);
+			Node** splitRef = current;
+			while (*splitRef != split)
+				splitRef = &static_cast<Node4*>(*splitRef)->children[0];
+
+			depth += common;
+			Leaf* leaf = new Leaf(newData);
+			if (depth == existingKey.size())
+				split->terminal = existing;
+			else
+				addChild(splitRef, existingKey.data()[depth], existing);
+
+			if (depth == key.size())
+				static_cast<Inner*>(*splitRef)->terminal = leaf;
+			else
+				addChild(splitRef, key.data()[depth], leaf);
+
+			++sz;
+			return true;
+		}
+
+		Inner* node = static_cast<Inner*>(*current);
+		size_t matched = prefixMismatch(node, key, depth);
+		if (matched < node->prefixLen)
+		{
+			// The key leaves the compressed path in the middle: split the prefix.
+			Node4* split = new Node4();
+			split->prefixLen = (uint8_t)matched;
+			std::memcpy(split->prefix, node->prefix, matched);
+
+			uint8_t edge = node->prefix[matched];
+			node->prefixLen = (uint8_t)(node->prefixLen - matched - 1);
+			std::memmove(node->prefix, node->prefix + matched + 1, node->prefixLen);
+
+			split->keys[0] = edge;
+			split->children[0] = node;
+			split->count = 1;
+			*current = split;
+
+			depth += matched;
+			Leaf* leaf = new Leaf(newData);
+			if (depth == key.size())
+				split->terminal = leaf;
+			else
+				addChild(current, key.data()[depth], leaf);
+
+			++sz;
+			return true;
+		}
+
+		depth += node->prefixLen;
+		if (depth == key.size())
+		{
+			if (node->terminal)
+				return false;
+			node->terminal = new Leaf(newData);
+			++sz;
+			return true;
+		}
+
+		Node** child = findChild(node, key.data()[depth]);
+		if (!child)
+		{
+			addChild(current, key.data()[depth], new Leaf(newData));
+			++sz;
+			return true;
+		}
+
+		current = child;
+		++depth;
+	}
+
+	*current = new Leaf(newData);
+	++sz;
+	return true;
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::insert(const Key& k, const Value& v)
+{
+	return insert(std::make_pair(k, v));
+}
+
+template <class Key, class Value, class Traits>
+const typename AdaptiveRadixMap<Key, Value, Traits>::Leaf* AdaptiveRadixMap<Key, Value, Traits>::findLeaf(const Key& k) const
+{
+	typename Traits::Encoded key(k);
+	Node* current = root;
+	size_t depth = 0;
+
+	while (current)
+	{
+		if (isLeaf(current))
+		{
+			const Leaf* leaf = static_cast<const Leaf*>(current);
+			return leafMatches(leaf, key) ? leaf : nullptr;
+		}
+
+		Inner* node = static_cast<Inner*>(current);
+		if (prefixMismatch(node, key, depth) < node->prefixLen)
+			return nullptr;
+
+		depth += node->prefixLen;
+		if (depth == key.size())
+			return node->terminal;
+
+		Node** child = findChild(node, key.data()[depth]);
+		current = child ? *child : nullptr;
+		++depth;
+	}
+
+	return nullptr;
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::containsKey(const Key& k) const
+{
+	return findLeaf(k) != nullptr;
+}
+
+template <class Key, class Value, class Traits>
+const Value* AdaptiveRadixMap<Key, Value, Traits>::find(const Key& k) const
+{
+	const Leaf* leaf = findLeaf(k);
+	return leaf ? &leaf->data.second : nullptr;
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::remove(Node** ref, const typename Traits::Encoded& key, size_t depth)
+{
+	if (!*ref)
+		return false;
+
+	if (isLeaf(*ref))
+	{
+		if (!leafMatches(static_cast<Leaf*>(*ref), key))
+			return false;
+		delete static_cast<Leaf*>(*ref);
+		*ref = nullptr;
+		return true;
+	}
+
+	Inner* node = static_cast<Inner*>(*ref);
+	if (prefixMismatch(node, key, depth) < node->prefixLen)
+		return false;
+
+	depth += node->prefixLen;
+	if (depth == key.size())
+	{
+		if (!node->terminal)
+			return false;
+		delete node->terminal;
+		node->terminal = nullptr;
+		shrink(ref);
+		return true;
+	}
+
+	uint8_t byte = key.data()[depth];
+	Node** child = findChild(node, byte);
+	if (!child || !remove(child, key, depth + 1))
+		return false;
+
+	if (!*child)
+		removeChild(ref, byte);
+	else
+		shrink(ref);
+	return true;
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::remove(const Key& k)
+{
+	typename Traits::Encoded key(k);
+	if (!remove(&root, key, 0))
+		return false;
+
+	--sz;
+	return true;
+}
+
+template <class Key, class Value, class Traits>
+size_t AdaptiveRadixMap<Key, Value, Traits>::size() const
+{
+	return sz;
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::empty() const
+{
+	return sz == 0;
+}
+
+template <class Key, class Value, class Traits>
+template <class Function>
+void AdaptiveRadixMap<Key, Value, Traits>::forEachWithPrefix(const Key& prefix, Function fn) const
+{
+	typename Traits::Encoded key(prefix);
+	const Node* current = root;
+	size_t depth = 0;
+
+	while (current && depth < key.size())
+	{
+		if (isLeaf(current))
+		{
+			typename Traits::Encoded leafKey(static_cast<const Leaf*>(current)->data.first);
+			if (leafKey.size() < key.size() || std::memcmp(leafKey.data(), key.data(), key.size()) != 0)
+				return;
+			break;
+		}
+
+		Inner* node = const_cast<Inner*>(static_cast<const Inner*>(current));
+		size_t matched = prefixMismatch(node, key, depth);
+		if (depth + matched == key.size())
+			break;
+		if (matched < node->prefixLen)
+			return;
+
+		depth += node->prefixLen;
+		Node** child = findChild(node, key.data()[depth]);
+		current = child ? *child : nullptr;
+		++depth;
+	}
+
+	if (!current)
+		return;
+
+	for (ConstIterator it(current), end; it != end; ++it)
+		fn(*it);
+}
+
+template <class Key, class Value, class Traits>
+void AdaptiveRadixMap<Key, Value, Traits>::ConstIterator::descend(const Node* node)
+{
+	if (!node)
+		return;
+
+	if (isLeaf(node))
+	{
+		current = static_cast<const Leaf*>(node);
+		return;
+	}
+
+	frames.push({ static_cast<const Inner*>(node), -1 });
+	advance();
+}
+
+// Shorter keys sort first, so an inner node yields its terminal leaf before
+// any of its children.
+template <class Key, class Value, class Traits>
+void AdaptiveRadixMap<Key, Value, Traits>::ConstIterator::advance()
+{
+	current = nullptr;
+	while (!frames.empty())
+	{
+		Frame& top = frames.top();
+		if (top.position == -1)
+		{
+			top.position = 0;
+			if (top.node->terminal)
+			{
+				current = top.node->terminal;
+				return;
+			}
+		}
+
+		const Node* child = childAt(top.node, top.position);
+		if (!child)
+		{
+			frames.pop();
+			continue;
+		}
+
+		if (isLeaf(child))
+		{
+			current = static_cast<const Leaf*>(child);
+			return;
+		}
+
+		frames.push({ static_cast<const Inner*>(child), -1 });
+	}
+}
+
+template <class Key, class Value, class Traits>
+AdaptiveRadixMap<Key, Value, Traits>::ConstIterator::ConstIterator(const Node* root) : current(nullptr)
+{
+	descend(root);
+}
+
+template <class Key, class Value, class Traits>
+const std::pair<Key, Value>& AdaptiveRadixMap<Key, Value, Traits>::ConstIterator::operator*() const
+{
+	return current->data;
+}
+
+template <class Key, class Value, class Traits>
+typename AdaptiveRadixMap<Key, Value, Traits>::ConstIterator& AdaptiveRadixMap<Key, Value, Traits>::ConstIterator::operator++()
+{
+	advance();
+	return *this;
+}
+
+template <class Key, class Value, class Traits>
+typename AdaptiveRadixMap<Key, Value, Traits>::ConstIterator AdaptiveRadixMap<Key, Value, Traits>::ConstIterator::operator++(int)
+{
+	ConstIterator temp = *this;
+	++(*this);
+	return temp;
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::ConstIterator::operator==(const ConstIterator& other) const
+{
+	return current == other.current;
+}
+
+template <class Key, class Value, class Traits>
+bool AdaptiveRadixMap<Key, Value, Traits>::ConstIterator::operator!=(const ConstIterator& other) const
+{
+	return !(*this == other);
+}
+
+template <class Key, class Value, class Traits>
+typename AdaptiveRadixMap<Key, Value, Traits>::ConstIterator AdaptiveRadixMap<Key, Value, Traits>::cbegin() const
+{
+	return ConstIterator(root);
+}
+
+template <class Key, class Value, class Traits>
+typename AdaptiveRadixMap<Key, Value, Traits>::ConstIterator AdaptiveRadixMap<Key, Value, Traits>::cend() const
+{
+	return ConstIterator(nullptr);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+// Lock-free union-find for many threads at once. A root is only ever linked
+// under a root with a smaller index, which a single compare-and-swap does, and
+// since parents always have smaller indices two concurrent unions can never
+// form a cycle. getRoot halves the path as it walks, each shortcut again being
+// a compare-and-swap that only ever points a node at one of its ancestors.
+class ConcurrentUnionFind
+{
+public:
+
+	explicit ConcurrentUnionFind(size_t n);
+
+	uint32_t getRoot(uint32_t n);
+	bool areInOneSet(uint32_t n, uint32_t k);
+
+	// True for the one call that actually joined the two sets
+	bool Union(uint32_t n, uint32_t k);
+
+private:
+
+	std::vector<std::atomic<uint32_t>> parent;
+};
+
+inline ConcurrentUnionFind::ConcurrentUnionFind(size_t n) : parent(n)
+{
+	for (size_t i = 0; i < n; ++i)
+		parent[i].store((uint32_t)i, std::memory_order_relaxed);
+}
+
+inline uint32_t ConcurrentUnionFind::getRoot(uint32_t n)
+{
+	while (true)
+	{
+		uint32_t p = parent[n].load(std::memory_order_relaxed);
+		if (p == n)
+			return n;
+
+		uint32_t grandparent = parent[p].load(std::memory_order_relaxed);
+		if (grandparent != p)
+			parent[n].compare_exchange_weak(p, grandparent, std::memory_order_relaxed);
+		n = grandparent;
+	}
+}
+
+inline bool ConcurrentUnionFind::areInOneSet(uint32_t n, uint32_t k)
+{
+	// Roots can change under us, so different roots are only trusted when n's
+	// root is still a root after k's was found
+	while (true)
+	{
+		uint32_t root1 = getRoot(n);
+		uint32_t root2 = getRoot(k);
+		if (root1 == root2)
+			return true;
+		if (parent[root1].load(std::memory_order_relaxed) == root1)
+			return false;
+	}
+}
+
+inline bool ConcurrentUnionFind::Union(uint32_t n, uint32_t k)
+{
+	while (true)
+	{
+		uint32_t root1 = getRoot(n);
+		uint32_t root2 = getRoot(k);
+		if (root1 == root2)
+			return false;
+
+		if (root1 < root2)
+			std::swap(root1, root2);
+
+		uint32_t expected = root1;
+		if (parent[root1].compare_exchange_strong(expected, root2, std::memory_order_relaxed))
+			return true;
+	}
+}
@@ -0,0 +1,264 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+// Sorted-array map for data that is built once and queried many times.
+// Keys and values live in two parallel arrays, so a lookup only touches the keys.
+template <class Key, class Value, class Compare = std::less<Key>>
+class FlatMap
+{
+private:
+	std::vector<Key> keys;
+	std::vector<Value> values;
+	Compare comp;
+
+	size_t lowerBound(const Key& k) const;
+	bool equal(const Key& lhs, const Key& rhs) const;
+	void sortAndUnique(std::vector<std::pair<Key, Value>>& items) const;
+
+public:
+	FlatMap() = default;
+	explicit FlatMap(const Compare& comparator);
+	explicit FlatMap(std::vector<std::pair<Key, Value>> items, const Compare& comparator = Compare());
+
+	bool insert(const std::pair<Key, Value>& newData);
+	bool insert(const Key& k, const Value& v);
+	size_t insert_batch(std::vector<std::pair<Key, Value>> batch);
+	bool containsKey(const Key& k) const;
+	bool remove(const Key& k);
+	size_t size() const;
+	bool empty() const;
+	void reserve(size_t n);
+
+	class ConstIterator
+	{
+	private:
+		const FlatMap* owner;
+		size_t index;
+
+	public:
+		ConstIterator(const FlatMap* owner = nullptr, size_t index = 0);
+		std::pair<const Key&, const Value&> operator*() const;
+		ConstIterator& operator++();
+		ConstIterator operator++(int);
+		bool operator==(const ConstIterator& other) const;
+		bool operator!=(const ConstIterator& other) const;
+	};
+
+	ConstIterator find(const Key& k) const;
+	ConstIterator cbegin() const;
+	ConstIterator cend() const;
+};
+
+
+// Branchless lower bound: the loop has a fixed trip count of log2(n) and
+// the conditional is compiled to a cmov, so there is nothing to mispredict.
+template <class Key, class Value, class Compare>
+size_t FlatMap<Key, Value, Compare>::lowerBound(const Key& k) const
+{
+	size_t n = keys.size();
+	if (n == 0)
+		return 0;
+
+	const Key* base = keys.data();
+	while (n > 1)
+	{
+		size_t half = n / 2;
+		base = comp(base[half], k) ? base + half : base;
+		n -= half;
+	}
+	return (base - keys.data()) + comp(*base, k);
+}
+
+template <class Key, class Value, class Compare>
+bool FlatMap<Key, Value, Compare>::equal(const Key& lhs, const Key& rhs) const
+{
+	return !comp(lhs, rhs) && !comp(rhs, lhs);
+}
+
+// Sorts by key and keeps the first occurrence of every key, the same one a
+// sequence of insert() calls would keep.
+template <class Key, class Value, class Compare>
+void FlatMap<Key, Value, Compare>::sortAndUnique(std::vector<std::pair<Key, Value>>& items) const
+{
+	std::stable_sort(items.begin(), items.end(), [this](const std::pair<Key, Value>& lhs, const std::pair<Key, Value>& rhs) {
+		return comp(lhs.first, rhs.first);
+		});
+
+	auto last = std::unique(items.begin(), items.end(), [this](const std::pair<Key, Value>& lhs, const std::pair<Key, Value>& rhs) {
+		return equal(lhs.first, rhs.first);
+		});
+	items.erase(last, items.end());
+}
+
+template <class Key, class Value, class Compare>
+FlatMap<Key, Value, Compare>::FlatMap(const Compare& comparator) : comp(comparator) {}
+
+template <class Key, class Value, class Compare>
+FlatMap<Key, Value, Compare>::FlatMap(std::vector<std::pair<Key, Value>> items, const Compare& comparator) : comp(comparator)
+{
+	sortAndUnique(items);
+
+	keys.reserve(items.size());
+	values.reserve(items.size());
+	for (auto& item : items)
+	{
+		keys.push_back(std::move(item.first));
+		values.push_back(std::move(item.second));
+	}
+}
+
+template <class Key, class Value, class Compare>
+bool FlatMap<Key, Value, Compare>::insert(const std::pair<Key, Value>& newData)
+{
+	size_t pos = lowerBound(newData.first);
+	if (pos < keys.size() && !comp(newData.first, keys[pos]))
+		return false;
+
+	keys.insert(keys.begin() + pos, newData.first);
+	values.insert(values.begin() + pos, newData.second);
+	return true;
+}
+
+template <class Key, class Value, class Compare>
+bool FlatMap<Key, Value, Compare>::insert(const Key& k, const Value& v)
+{
+	return insert(std::make_pair(k, v));
+}
+
+// Sorts the batch and merges it with the existing arrays in one linear pass
+// instead of shifting the tail once per element. Keys that are already present
+// are left untouched, as with insert(). Returns the number of inserted keys.
+template <class Key, class Value, class Compare>
+size_t FlatMap<Key, Value, Compare>::insert_batch(std::vector<std::pair<Key, Value>> batch)
+{
+	sortAndUnique(batch);
+
+	std::vector<Key> mergedKeys;
+	std::vector<Value> mergedValues;
+	mergedKeys.reserve(keys.size() + batch.size());
+	mergedValues.reserve(values.size() + batch.size());
+
+	size_t i = 0, j = 0, inserted = 0;
+	while (i < keys.size() || j < batch.size())
+	{
+		if (j == batch.size() || (i < keys.size() && comp(keys[i], batch[j].first)))
+		{
+			mergedKeys.push_back(std::move(keys[i]));
+			mergedValues.push_back(std::move(values[i]));
+			++i;
+		}
+		else if (i == keys.size() || comp(batch[j].first, keys[i]))
+		{
+			mergedKeys.push_back(std::move(batch[j].first));
+			mergedValues.push_back(std::move(batch[j].second));
+			++j;
+			++inserted;
+		}
+		else
+		{
+			++j;
+		}
+	}
+
+	keys.swap(mergedKeys);
+	values.swap(mergedValues);
+	return inserted;
+}
+
+template <class Key, class Value, class Compare>
+bool FlatMap<Key, Value, Compare>::containsKey(const Key& k) const
+{
+	size_t pos = lowerBound(k);
+	return pos < keys.size() && !comp(k, keys[pos]);
+}
+
+template <class Key, class Value, class Compare>
+bool FlatMap<Key, Value, Compare>::remove(const Key& k)
+{
+	size_t pos = lowerBound(k);
+	if (pos == keys.size() || comp(k, keys[pos]))
+		return false;
+
+	keys.erase(keys.begin() + pos);
+	values.erase(values.begin() + pos);
+	return true;
+}
+
+template <class Key, class Value, class Compare>
+size_t FlatMap<Key, Value, Compare>::size() const
+{
+	return keys.size();
+}
+
+template <class Key, class Value, class Compare>
+bool FlatMap<Key, Value, Compare>::empty() const
+{
+	return keys.empty();
+}
+
+template <class Key, class Value, class Compare>
+void FlatMap<Key, Value, Compare>::reserve(size_t n)
+{
+	keys.reserve(n);
+	values.reserve(n);
+}
+
+template <class Key, class Value, class Compare>
+FlatMap<Key, Value, Compare>::ConstIterator::ConstIterator(const FlatMap* owner, size_t index) : owner(owner), index(index) {}
+
+template <class Key, class Value, class Compare>
+std::pair<const Key&, const Value&> FlatMap<Key, Value, Compare>::ConstIterator::operator*() const
+{
+	return { owner->keys[index], owner->values[index] };
+}
+
+template <class Key, class Value, class Compare>
+typename FlatMap<Key, Value, Compare>::ConstIterator& FlatMap<Key, Value, Compare>::ConstIterator::operator++()
+{
+	++index;
+	return *this;
+}
+
+template <class Key, class Value, class Compare>
+typename FlatMap<Key, Value, Compare>::ConstIterator FlatMap<Key, Value, Compare>::ConstIterator::operator++(int)
+{
+	ConstIterator temp = *this;
+	++(*this);
+	return temp;
+}
+
+template <class Key, class Value, class Compare>
+bool FlatMap<Key, Value, Compare>::ConstIterator::operator==(const ConstIterator& other) const
+{
+	return owner == other.owner && index == other.index;
+}
+
+template <class Key, class Value, class Compare>
+bool FlatMap<Key, Value, Compare>::ConstIterator::operator!=(const ConstIterator& other) const
+{
+	return !(*this == other);
+}
+
+template <class Key, class Value, class Compare>
+typename FlatMap<Key, Value, Compare>::ConstIterator FlatMap<Key, Value, Compare>::find(const Key& k) const
+{
+	size_t pos = lowerBound(k);
+	if (pos == keys.size() || comp(k, keys[pos]))
+		return cend();
+	return ConstIterator(this, pos);
+}
+
+template <class Key, class Value, class Compare>
+typename FlatMap<Key, Value, Compare>::ConstIterator FlatMap<Key, Value, Compare>::cbegin() const
+{
+	return ConstIterator(this, 0);
+}
+
+template <class Key, class Value, class Compare>
+typename FlatMap<Key, Value, Compare>::ConstIterator FlatMap<Key, Value, Compare>::cend() const
+{
+	return ConstIterator(this, keys.size());
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <string>
+#include "FlatMap.h"
+#include "../Map/Map.cpp"
+#include "../Graph/Benchmark.h"
+
+// Lookup time of FlatMap against Map for 1K keys up to maxKeys (10M unless
+// given on the command line). 100M keys need about 4 GB: Map alone
+// allocates one 24-byte node per key plus allocator overhead, next to the
+// 800 MB of input pairs.
+//
+// The keys 0, 2, 4, ... are inserted into Map in random order, so its
+// unbalanced tree is about 2 ln n deep on average, and FlatMap is bulk built from
+// the same pairs. Both answer the same LOOKUPS random probes, about half of
+// which are present.
+
+const size_t LOOKUPS = 1000000;
+
+void benchmark(size_t n, std::mt19937& random)
+{
+	std::vector<std::pair<int, int>> items(n);
+	for (size_t i = 0; i < n; ++i)
+		items[i] = { (int)(2 * i), (int)i };
+	std::shuffle(items.begin(), items.end(), random);
+
+	std::vector<int> probes(LOOKUPS);
+	std::uniform_int_distribution<int> anyKey(0, (int)(2 * n));
+	for (int& probe : probes)
+		probe = anyKey(random);
+
+	size_t mapFound = 0;
+	size_t flatFound = 0;
+	double mapLookup;
+	double flatLookup;
+	{
+		Map<int, int> map;
+		for (const auto& item : items)
+			map.insert(item);
+
+		mapLookup = timeSeconds([&] {
+			for (int probe : probes)
+				mapFound += map.containsKey(probe);
+		});
+	}
+	{
+		FlatMap<int, int> flat(std::move(items));
+
+		flatLookup = timeSeconds([&] {
+			for (int probe : probes)
+				flatFound += flat.containsKey(probe);
+		});
+	}
+
+	std::cout << n << "\t" << mapLookup * 1e9 / LOOKUPS << "\t" << flatLookup * 1e9 / LOOKUPS
+		<< "\t" << mapLookup / flatLookup << "x" << (mapFound == flatFound ? "" : "\tMISMATCH") << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	size_t maxKeys = argc > 1 ? std::stoul(argv[1]) : 10000000;
+	std::mt19937 random(2024);
+
+	std::cout << "keys\tMap ns\tFlatMap ns\tspeedup" << std::endl;
+	for (size_t n = 1000; n <= maxKeys; n *= 10)
+		benchmark(n, random);
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+// Sorted-array set for data that is built once and queried many times.
+template<typename T, typename Compare = std::less<T>>
+class FlatSet
+{
+public:
+
+	FlatSet() = default;
+	explicit FlatSet(const Compare& comparator) : comp(comparator) {}
+	explicit FlatSet(std::vector<T> elements, const Compare& comparator = Compare());
+
+	bool insert(const T& el);
+	size_t insert_batch(std::vector<T> batch);
+	bool contains(const T& el) const;
+	bool remove(const T& el);
+
+	size_t getSize() const;
+	bool isEmpty() const;
+	void reserve(size_t n);
+
+	using ConstIterator = typename std::vector<T>::const_iterator;
+
+	ConstIterator find(const T& el) const
+	{
+		size_t pos = lowerBound(el);
+		if (pos == data.size() || comp(el, data[pos]))
+			return cend();
+		return data.cbegin() + pos;
+	}
+
+	ConstIterator cbegin() const
+	{
+		return data.cbegin();
+	}
+
+	ConstIterator cend() const
+	{
+		return data.cend();
+	}
+
+private:
+
+	std::vector<T> data;
+	Compare comp;
+
+	size_t lowerBound(const T& el) const;
+	void sortAndUnique(std::vector<T>& elements) const;
+};
+
+// Branchless lower bound, see FlatMap::lowerBound.
+template<typename T, typename Compare>
+size_t FlatSet<T, Compare>::lowerBound(const T& el) const
+{
+	size_t n = data.size();
+	if (n == 0)
+		return 0;
+
+	const T* base = data.data();
+	while (n > 1)
+	{
+		size_t half = n / 2;
+		base = comp(base[half], el) ? base + half : base;
+		n -= half;
+	}
+
+	return (base - data.data()) + comp(*base, el);
+}
+
+template<typename T, typename Compare>
+void FlatSet<T, Compare>::sortAndUnique(std::vector<T>& elements) const
+{
+	std::sort(elements.begin(), elements.end(), comp);
+
+	auto last = std::unique(elements.begin(), elements.end(), [this](const T& lhs, const T& rhs) {
+		return !comp(lhs, rhs) && !comp(rhs, lhs);
+		});
+	elements.erase(last, elements.end());
+}
+
+template<typename T, typename Compare>
+FlatSet<T, Compare>::FlatSet(std::vector<T> elements, const Compare& comparator) : data(std::move(elements)), comp(comparator)
+{
+	sortAndUnique(data);
+}
+
+template<typename T, typename Compare>
+bool FlatSet<T, Compare>::insert(const T& el)
+{
+	size_t pos = lowerBound(el);
+	if (pos < data.size() && !comp(el, data[pos]))
+		return false;
+
+	data.insert(data.begin() + pos, el);
+	return true;
+}
+
+// Sorts the batch and merges it with the existing array in one linear pass.
+// Returns the number of elements that were not already in the set.
+template<typename T, typename Compare>
+size_t FlatSet<T, Compare>::insert_batch(std::vector<T> batch)
+{
+	sortAndUnique(batch);
+
+	std::vector<T> merged;
+	merged.reserve(data.size() + batch.size());
+
+	size_t i = 0, j = 0, inserted = 0;
+	while (i < data.size() || j < batch.size())
+	{
+		if (j == batch.size() || (i < data.size() && comp(data[i], batch[j])))
+		{
+			merged.push_back(std::move(data[i++]));
+		}
+		else if (i == data.size() || comp(batch[j], data[i]))
+		{
+			merged.push_back(std::move(batch[j++]));
+			++inserted;
+		}
+		else
+		{
+			++j;
+		}
+	}
+
+	data.swap(merged);
+	return inserted;
+}
+
+template<typename T, typename Compare>
+bool FlatSet<T, Compare>::contains(const T& el) const
+{
+	size_t pos = lowerBound(el);
+	return pos < data.size() && !comp(el, data[pos]);
+}
+
+template<typename T, typename Compare>
+bool FlatSet<T, Compare>::remove(const T& el)
+{
+	size_t pos = lowerBound(el);
+	if (pos == data.size() || comp(el, data[pos]))
+		return false;
+
+	data.erase(data.begin() + pos);
+	return true;
+}
+
+template <class T, typename Compare>
+size_t FlatSet<T, Compare>::getSize() const
+{
+	return data.size();
+}
+
+template <class T, typename Compare>
+bool FlatSet<T, Compare>::isEmpty() const
+{
+	return getSize() == 0;
+}
+
+template <class T, typename Compare>
+void FlatSet<T, Compare>::reserve(size_t n)
+{
+	data.reserve(n);
+}
@@ -1,254 +1,909 @@
-Node* buildBalanced(const std::vector<T>& start, int l, int end)
-{
-        if (start > end) return nullptr;
-        int m = (start + end) / 2;
-        Node* node = new Node(a[m]);
-        node->left  = buildBalanced(a, stara, m - 1);
-        node->right = buildBalanced(a, m + 1, end);
-        return node;
-}
-
-
-
 // C++ Program to Implement Balanced Binary Tree
 #include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <iostream>
+#include <random>
+#include <stack>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Benchmark.h"
 using namespace std;
 
-template <typename T> class BalancedBinaryTree {
+// Per-subtree summary kept in every node. The default keeps nothing.
+template <typename T> struct NoAugmentation {
+    struct Summary {
+        bool operator==(const Summary&) const { return true; }
+    };
+
+    static Summary summarize(const T&, const Summary*, const Summary*) { return Summary(); }
+};
+
+// Closed interval [lo, hi], ordered by lo and then by hi
+template <typename E> struct Interval {
+    E lo;
+    E hi;
+
+    bool operator<(const Interval& other) const
+    {
+        return lo < other.lo || (!(other.lo < lo) && hi < other.hi);
+    }
+};
+
+// Keeps the largest right endpoint in each subtree, which lets a query
+// skip every subtree that ends before the query starts
+template <typename E> struct IntervalAugmentation {
+    struct Summary {
+        E maxEnd;
+
+        bool operator==(const Summary& other) const
+        {
+            return !(maxEnd < other.maxEnd) && !(other.maxEnd < maxEnd);
+        }
+    };
+
+    static Summary summarize(const Interval<E>& data, const Summary* left, const Summary* right)
+    {
+        Summary result{ data.hi };
+        if (left && result.maxEnd < left->maxEnd)
+            result.maxEnd = left->maxEnd;
+        if (right && result.maxEnd < right->maxEnd)
+            result.maxEnd = right->maxEnd;
+        return result;
+    }
+};
+
+// AVL insertion, removal and rebalancing, written once for any node layout.
+// Access is a small handle onto one tree that provides:
+//   Ref, NIL                       node handle and the empty handle
+//   root(), setRoot(n)
+//   left(n), right(n)
+//   setLeft(n, c), setRight(n, c)  link c as a child of n (c may be NIL)
+//   height(n)                      0 for NIL
+//   update(n)                      recompute n's height and any subtree data
+//   snapshot(n)                    the values update() writes, comparable with ==
+//   data(n), moveData(to, from)
+//   allocate(key), release(n)
+// Updates record the search path in a fixed array and walk back up it, so the
+// nodes need no parent link; a layout that keeps one sets it in setLeft,
+// setRight and setRoot, which every relinking goes through.
+template <typename Access> struct AvlBalancing {
+    using Ref = typename Access::Ref;
+
+    // An AVL tree of 2^64 nodes is less than 93 levels deep
+    static const int MAX_HEIGHT = 96;
+
+    static int balanceFactor(const Access& a, Ref node)
+    {
+        return node == Access::NIL ? 0 : a.height(a.left(node)) - a.height(a.right(node));
+    }
+
+    // Right rotation; the caller links the returned node in y's place
+    static Ref rotateRight(Access& a, Ref y)
+    {
+        Ref x = a.left(y);
+        a.setLeft(y, a.right(x));
+        a.setRight(x, y);
+
+        a.update(y);
+        a.update(x);
+
+        return x;
+    }
+
+    // Left rotation; the caller links the returned node in x's place
+    static Ref rotateLeft(Access& a, Ref x)
+    {
+        Ref y = a.right(x);
+        a.setRight(x, a.left(y));
+        a.setLeft(y, x);
+
+        a.update(x);
+        a.update(y);
+
+        return y;
+    }
+
+    // Restores the AVL property at node with a single or double rotation
+    // and returns the new root of the subtree
+    static Ref rebalance(Access& a, Ref node)
+    {
+        int balance = balanceFactor(a, node);
+
+        if (balance > 1) {
+            // Left Right Case
+            if (balanceFactor(a, a.left(node)) < 0)
+                a.setLeft(node, rotateLeft(a, a.left(node)));
+            // Left Left Case
+            return rotateRight(a, node);
+        }
+
+        if (balance < -1) {
+            // Right Left Case
+            if (balanceFactor(a, a.right(node)) > 0)
+                a.setRight(node, rotateRight(a, a.right(node)));
+            // Right Right Case
+            return rotateLeft(a, node);
+        }
+
+        return node;
+    }
+
+    // Points the link that led from path[i - 1] to path[i] at newChild
+    static void relink(Access& a, const Ref* path, int i, Ref newChild)
+    {
+        if (i == 0)
+            a.setRoot(newChild);
+        else if (a.left(path[i - 1]) == path[i])
+            a.setLeft(path[i - 1], newChild);
+        else
+            a.setRight(path[i - 1], newChild);
+    }
+
+    // Fixes heights, subtree data and balance along path[0..depth) from the
+    // bottom up. The walk stops as soon as a subtree ends up as it was before
+    // the update, because nothing above it can have changed.
+    static void retrace(Access& a, Ref* path, int depth)
+    {
+        for (int i = depth - 1; i >= 0; --i) {
+            auto old = a.snapshot(path[i]);
+            a.update(path[i]);
+            Ref subtree = rebalance(a, path[i]);
+            relink(a, path, i, subtree);
+
+            if (a.snapshot(subtree) == old)
+                return;
+        }
+    }
+
+    // Recomputes subtree data along path[0..=i] after path[i]'s key changed,
+    // stopping where nothing changes
+    static void refresh(Access& a, const Ref* path, int i)
+    {
+        for (; i >= 0; --i) {
+            auto old = a.snapshot(path[i]);
+            a.update(path[i]);
+            if (a.snapshot(path[i]) == old)
+                return;
+        }
+    }
+
+    // Returns false if the key is already present
+    template <typename K> static bool insert(Access& a, K&& key)
+    {
+        Ref path[MAX_HEIGHT];
+        int depth = 0;
+
+        Ref current = a.root();
+        while (current != Access::NIL) {
+            path[depth++] = current;
+            if (key < a.data(current))
+                current = a.left(current);
+            else if (a.data(current) < key)
+                current = a.right(current);
+            else
+                return false; // Duplicate keys are not allowed
+        }
+
+        bool goesLeft = depth > 0 && key < a.data(path[depth - 1]);
+        Ref node = a.allocate(std::forward<K>(key));
+        if (depth == 0)
+            a.setRoot(node);
+        else if (goesLeft)
+            a.setLeft(path[depth - 1], node);
+        else
+            a.setRight(path[depth - 1], node);
+
+        retrace(a, path, depth);
+        return true;
+    }
+
+    // Returns false if the key is not present
+    template <typename K> static bool remove(Access& a, const K& key)
+    {
+        Ref path[MAX_HEIGHT];
+        int depth = 0;
+
+        Ref current = a.root();
+        while (current != Access::NIL) {
+            path[depth++] = current;
+            if (key < a.data(current))
+                current = a.left(current);
+            else if (a.data(current) < key)
+                current = a.right(current);
+            else
+                break;
+        }
+
+        if (current == Access::NIL)
+            return false;
+
+        // A node with two children takes over its successor's key,
+        // and the successor (which has no left child) is unlinked instead
+        int replaced = -1;
+        if (a.left(current) != Access::NIL && a.right(current) != Access::NIL) {
+            replaced = depth - 1;
+            Ref successor = a.right(current);
+            path[depth++] = successor;
+            while (a.left(successor) != Access::NIL) {
+                successor = a.left(successor);
+                path[depth++] = successor;
+            }
+            a.moveData(current, successor);
+            current = successor;
+        }
+
+        Ref child = a.left(current) != Access::NIL ? a.left(current) : a.right(current);
+        relink(a, path, depth - 1, child);
+        a.release(current);
+
+        retrace(a, path, depth - 1);
+        if (replaced >= 0)
+            refresh(a, path, replaced);
+        return true;
+    }
+};
+
+template <typename T, typename Augmentation = NoAugmentation<T>> class BalancedBinaryTree {
 private:
+    using Summary = typename Augmentation::Summary;
+
     // Node structure definition
     struct Node {
         T data;
         Node* left;
         Node* right;
+        Node* parent;
         int height;
-
-        Node(T value) : data(value), left(nullptr), right(nullptr), height(1) {}
+        Summary summary;
+
+        Node(const T& value, Node* parent)
+            : data(value), left(nullptr), right(nullptr), parent(parent), height(1),
+              summary(Augmentation::summarize(data, nullptr, nullptr)) {}
+        Node(T&& value, Node* parent)
+            : data(std::move(value)), left(nullptr), right(nullptr), parent(parent), height(1),
+              summary(Augmentation::summarize(data, nullptr, nullptr)) {}
     };
 
     Node* root;
+    size_t sz;
 
     // Function to get the height of the node
-    int height(Node* node)
+    static int height(const Node* node)
     {
         return node ? node->height : 0;
     }
 
-    // Function to get the balance factor of the node
-    int balanceFactor(Node* node)
+    // Function to update the height and the summary of the node
+    static void updateHeight(Node* node)
     {
-        return node ? height(node->left) - height(node->right) : 0;
+        node->height = 1 + max(height(node->left), height(node->right));
+        node->summary = Augmentation::summarize(node->data,
+                                                node->left ? &node->left->summary : nullptr,
+                                                node->right ? &node->right->summary : nullptr);
     }
 
-    // Function to update the height of the node
-    void updateHeight(Node* node)
+    // Node access for AvlBalancing. Every link it makes also sets the
+    // child's parent pointer, which the iterator walks. A detached Access
+    // (no root slot) is enough for the rotations used by join.
+    struct Access {
+        using Ref = Node*;
+        static constexpr Node* NIL = nullptr;
+
+        struct Snapshot {
+            int height;
+            Summary summary;
+
+            bool operator==(const Snapshot& other) const
+            {
+                return height == other.height && summary == other.summary;
+            }
+        };
+
+        Node** rootSlot;
+
+        Node* root() const { return *rootSlot; }
+        void setRoot(Node* node)
+        {
+            *rootSlot = node;
+            if (node)
+                node->parent = nullptr;
+        }
+
+        static Node* left(const Node* node) { return node->left; }
+        static Node* right(const Node* node) { return node->right; }
+        static void setLeft(Node* node, Node* child)
+        {
+            node->left = child;
+            if (child)
+                child->parent = node;
+        }
+        static void setRight(Node* node, Node* child)
+        {
+            node->right = child;
+            if (child)
+                child->parent = node;
+        }
+
+        static int height(const Node* node) { return BalancedBinaryTree::height(node); }
+        static void update(Node* node) { updateHeight(node); }
+        static Snapshot snapshot(const Node* node) { return { node->height, node->summary }; }
+
+        static const T& data(const Node* node) { return node->data; }
+        static void moveData(Node* to, Node* from) { to->data = std::move(from->data); }
+        template <typename K> static Node* allocate(K&& key) { return new Node(std::forward<K>(key), nullptr); }
+        static void release(Node* node) { delete node; }
+    };
+
+    using Balancing = AvlBalancing<Access>;
+
+    static Node* rotateRight(Node* y)
     {
-        node->height = 1 + max(height(node->left), height(node->right));
+        Access detached{ nullptr };
+        return Balancing::rotateRight(detached, y);
     }
 
-    // Right rotation function
-    Node* rotateRight(Node* y)
+    static Node* rotateLeft(Node* x)
     {
-        Node* x = y->left;
-        Node* T2 = x->right;
+        Access detached{ nullptr };
+        return Balancing::rotateLeft(detached, x);
+    }
 
-        x->right = y;
-        y->left = T2;
+    // Reports every interval in the subtree that intersects [lo, hi], in order
+    template <typename E, typename Function>
+    static void overlapping(const Node* node, const E& lo, const E& hi, Function& fn)
+    {
+        if (!node || node->summary.maxEnd < lo)
+            return;
+
+        overlapping(node->left, lo, hi, fn);
+        if (hi < node->data.lo)
+            return;
+        if (!(node->data.hi < lo))
+            fn(node->data);
+        overlapping(node->right, lo, hi, fn);
+    }
 
-        updateHeight(y);
-        updateHeight(x);
+    // Function to insert a node
+    template <typename K> bool insertKey(K&& key)
+    {
+        Access access{ &root };
+        if (!Balancing::insert(access, std::forward<K>(key)))
+            return false; // Duplicate keys are not allowed
+        ++sz;
+        return true;
+    }
 
-        return x;
+    // Function to find the node with the minimum value
+    static Node* findMin(Node* node)
+    {
+        while (node->left)
+            node = node->left;
+        return node;
     }
 
-    // Left rotation function
-    Node* rotateLeft(Node* x)
+    // Function to find the node holding key
+    Node* findNode(const T& key) const
     {
-        Node* y = x->right;
-        Node* T2 = y->left;
+        Node* current = root;
+        while (current) {
+            if (key < current->data)
+                current = current->left;
+            else if (current->data < key)
+                current = current->right;
+            else
+                return current;
+        }
+        return nullptr;
+    }
 
-        y->left = x;
-        x->right = T2;
+    // Subtrees smaller than this are built and merged on the calling thread
+    static const size_t PARALLEL_CUTOFF = 1 << 14;
 
-        updateHeight(x);
-        updateHeight(y);
+    // Number of times the recursion may still fork a thread
+    static int forkDepth()
+    {
+        int depth = 0;
+        for (unsigned threads = thread::hardware_concurrency(); threads > 1; threads /= 2)
+            ++depth;
+        return depth;
+    }
 
-        return y;
+    // Makes k the root of a detached subtree with children l and r
+    static Node* link(Node* l, Node* k, Node* r)
+    {
+        k->left = l;
+        k->right = r;
+        k->parent = nullptr;
+        if (l)
+            l->parent = k;
+        if (r)
+            r->parent = k;
+        updateHeight(k);
+        return k;
     }
 
-    // Function to insert a node
-    Node* insert(Node* node, T key)
+    // Builds a perfectly balanced subtree from sorted, distinct keys. The two
+    // halves differ in size by at most one, so their heights differ by at most
+    // one and every node is AVL balanced without rotations
+    static Node* build(const T* keys, size_t n, int forks)
     {
-        // Perform the normal BST insertion
-        if (!node)
-            return new Node(key);
+        if (n == 0)
+            return nullptr;
 
-        if (key < node->data)
-            node->left = insert(node->left, key);
-        else if (key > node->data)
-            node->right = insert(node->right, key);
-        else
-            return node; // Duplicate keys are not allowed
+        size_t m = n / 2;
+        Node* node = new Node(keys[m], nullptr);
+        Node* left;
+        Node* right;
 
-        // Update height of this ancestor node
-        updateHeight(node);
+        if (forks > 0 && n > PARALLEL_CUTOFF) {
+            thread worker([&] { left = build(keys, m, forks - 1); });
+            right = build(keys + m + 1, n - m - 1, forks - 1);
+            worker.join();
+        }
+        else {
+            left = build(keys, m, 0);
+            right = build(keys + m + 1, n - m - 1, 0);
+        }
 
-        // Get the balance factor to check whether this node
-        // became unbalanced
-        int balance = balanceFactor(node);
+        return link(left, node, right);
+    }
 
-        // If the node becomes unbalanced, there are 4 cases
+    // Joins l < k < r where l is taller: walks down the right spine of l to a
+    // subtree of about r's height, hangs k there and rotates on the way back
+    static Node* joinRight(Node* l, Node* k, Node* r)
+    {
+        Node* ll = l->left;
+        Node* c = l->right;
+
+        if (height(c) <= height(r) + 1) {
+            Node* t = link(c, k, r);
+            if (t->height <= height(ll) + 1)
+                return link(ll, l, t);
+            return rotateLeft(link(ll, l, rotateRight(t)));
+        }
+
+        Node* t = joinRight(c, k, r);
+        Node* joined = link(ll, l, t);
+        if (t->height <= height(ll) + 1)
+            return joined;
+        return rotateLeft(joined);
+    }
 
-        // Left Left Case
-        if (balance > 1 && key < node->left->data)
-            return rotateRight(node);
+    // Mirror image of joinRight for a taller r
+    static Node* joinLeft(Node* l, Node* k, Node* r)
+    {
+        Node* c = r->left;
+        Node* rr = r->right;
+
+        if (height(c) <= height(l) + 1) {
+            Node* t = link(l, k, c);
+            if (t->height <= height(rr) + 1)
+                return link(t, r, rr);
+            return rotateRight(link(rotateLeft(t), r, rr));
+        }
+
+        Node* t = joinLeft(l, k, c);
+        Node* joined = link(t, r, rr);
+        if (t->height <= height(rr) + 1)
+            return joined;
+        return rotateRight(joined);
+    }
 
-        // Right Right Case
-        if (balance < -1 && key > node->right->data)
-            return rotateLeft(node);
+    // AVL join: a balanced tree holding l, then k, then r.
+    // Costs O(|height(l) - height(r)| + 1)
+    static Node* join(Node* l, Node* k, Node* r)
+    {
+        if (height(l) > height(r) + 1)
+            return joinRight(l, k, r);
+        if (height(r) > height(l) + 1)
+            return joinLeft(l, k, r);
+        return link(l, k, r);
+    }
 
-        // Left Right Case
-        if (balance > 1 && key > node->left->data) {
-            node->left = rotateLeft(node->left);
-            return rotateRight(node);
+    // Union of the detached subtree t with sorted, distinct keys. The keys are
+    // split around t's root, each side is merged into the matching child
+    // (in parallel when large enough) and the results are joined back under
+    // the root. Counts keys that were already present in duplicates
+    static Node* unionSorted(Node* t, const T* keys, size_t n, int forks, size_t& duplicates)
+    {
+        if (n == 0)
+            return t;
+        if (!t)
+            return build(keys, n, forks);
+
+        size_t lo = lower_bound(keys, keys + n, t->data) - keys;
+        size_t hi = lo;
+        if (hi < n && !(t->data < keys[hi])) {
+            ++hi;
+            ++duplicates;
         }
 
-        // Right Left Case
-        if (balance < -1 && key < node->right->data) {
-            node->right = rotateRight(node->right);
-            return rotateLeft(node);
+        Node* l = t->left;
+        Node* r = t->right;
+        if (l)
+            l->parent = nullptr;
+        if (r)
+            r->parent = nullptr;
+
+        if (forks > 0 && n > PARALLEL_CUTOFF) {
+            size_t leftDuplicates = 0;
+            thread worker([&] { l = unionSorted(l, keys, lo, forks - 1, leftDuplicates); });
+            r = unionSorted(r, keys + hi, n - hi, forks - 1, duplicates);
+            worker.join();
+            duplicates += leftDuplicates;
+        }
+        else {
+            l = unionSorted(l, keys, lo, 0, duplicates);
+            r = unionSorted(r, keys + hi, n - hi, 0, duplicates);
         }
 
-        return node;
+        return join(l, t, r);
     }
 
-    // Function to find the node with the minimum value
-    // (used in deletion)
-    Node* findMin(Node* node)
+    void free(Node* node)
     {
-        while (node->left)
-            node = node->left;
-        return node;
+        if (!node)
+            return;
+        free(node->left);
+        free(node->right);
+        delete node;
     }
 
-    // Function to delete a node
-    Node* remove(Node* node, T key)
+    Node* copy(const Node* node, Node* parent)
     {
-        // Perform standard BST delete
         if (!node)
             return nullptr;
+        Node* result = new Node(node->data, parent);
+        result->left = copy(node->left, result);
+        result->right = copy(node->right, result);
+        updateHeight(result);
+        return result;
+    }
 
-        if (key < node->data)
-            node->left = remove(node->left, key);
-        else if (key > node->data)
-            node->right = remove(node->right, key);
-        else
+public:
+    // In-order iterator that follows parent pointers, so it needs no stack
+    class ConstIterator {
+    private:
+        const Node* current;
+
+    public:
+        ConstIterator(const Node* node = nullptr) : current(node) {}
+
+        const T& operator*() const { return current->data; }
+        const T* operator->() const { return &current->data; }
+
+        ConstIterator& operator++()
         {
-            if (!node->left || !node->right)
-            {
-                Node* temp
-                    = node->left ? node->left : node->right;
-                if (!temp)
-                {
-                    temp = node;
-                    node = nullptr;
-                }
-                else
-                    *node = *temp;
-              
-                delete temp;
+            if (current->right) {
+                current = current->right;
+                while (current->left)
+                    current = current->left;
+                return *this;
             }
-            else
-            {
-                Node* temp = findMin(node->right);
-                node->data = temp->data;
-                node->right = remove(node->right, temp->data);
+
+            const Node* child = current;
+            current = current->parent;
+            while (current && current->right == child) {
+                child = current;
+                current = current->parent;
             }
+            return *this;
         }
 
-        if (!node)
-            return nullptr;
+        ConstIterator operator++(int)
+        {
+            ConstIterator temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        bool operator==(const ConstIterator& other) const { return current == other.current; }
+        bool operator!=(const ConstIterator& other) const { return current != other.current; }
+    };
+
+    // Constructor
+    BalancedBinaryTree() : root(nullptr), sz(0) {}
+
+    // Bulk load from keys that are sorted and distinct, in O(n)
+    explicit BalancedBinaryTree(const vector<T>& sorted)
+        : root(build(sorted.data(), sorted.size(), forkDepth())), sz(sorted.size()) {}
+    BalancedBinaryTree(const BalancedBinaryTree& other) : root(copy(other.root, nullptr)), sz(other.sz) {}
+    BalancedBinaryTree& operator=(const BalancedBinaryTree& other)
+    {
+        if (this != &other) {
+            free(root);
+            root = copy(other.root, nullptr);
+            sz = other.sz;
+        }
+        return *this;
+    }
+    ~BalancedBinaryTree() { free(root); }
+
+    // Public insert functions, return false if the key is already present
+    bool insert(const T& key) { return insertKey(key); }
+    bool insert(T&& key) { return insertKey(std::move(key)); }
+
+    // Inserts all keys in [first, last) at once: the batch is sorted and
+    // merged into the tree with joins, instead of one rotation sequence per
+    // key. Returns the number of keys that were not already present
+    template <typename Iterator> size_t insert_batch(Iterator first, Iterator last)
+    {
+        vector<T> keys(first, last);
+        sort(keys.begin(), keys.end());
+        keys.erase(unique(keys.begin(), keys.end(), [](const T& a, const T& b) {
+            return !(a < b) && !(b < a);
+        }), keys.end());
+
+        size_t duplicates = 0;
+        root = unionSorted(root, keys.data(), keys.size(), forkDepth(), duplicates);
+        if (root)
+            root->parent = nullptr;
+
+        sz += keys.size() - duplicates;
+        return keys.size() - duplicates;
+    }
 
-        // Update height of the current node
-        updateHeight(node);
+    // Public remove function, returns false if the key is not present
+    bool remove(const T& key)
+    {
+        Access access{ &root };
+        if (!Balancing::remove(access, key))
+            return false;
+        --sz;
+        return true;
+    }
+
+    // Public search function
+    bool search(const T& key) const { return findNode(key) != nullptr; }
+
+    // Interval trees only: calls fn for every stored interval that intersects
+    // [lo, hi], in order. Every subtree the walk enters either holds a
+    // reported interval or is cut off at its root, so a query costs
+    // O(min(n, (k + 1) log n)) for k reported intervals. That is short of
+    // O(log n + k), which needs a different structure such as a centered
+    // interval tree or a priority search tree.
+    template <typename E, typename Function>
+    void overlapping(const E& lo, const E& hi, Function fn) const { overlapping(root, lo, hi, fn); }
+
+    // Interval trees only: calls fn for every stored interval containing point
+    template <typename E, typename Function>
+    void stabbing(const E& point, Function fn) const { overlapping(root, point, point, fn); }
+
+    size_t size() const { return sz; }
+    bool empty() const { return sz == 0; }
+
+    // Bytes of one node, not counting the allocator's own per-allocation overhead
+    static size_t bytesPerNode() { return sizeof(Node); }
+
+    // In-order traversal of the tree
+    ConstIterator cbegin() const { return ConstIterator(root ? findMin(root) : nullptr); }
+    ConstIterator cend() const { return ConstIterator(nullptr); }
+};
 
-        // Get the balance factor
-        int balance = balanceFactor(node);
+// Same AVL tree with a compact node layout for large trees of small keys.
+// Nodes live in one contiguous pool and refer to each other by 32-bit index,
+// the height fits in a byte and there is no parent link, which AvlBalancing
+// does not need. For int keys a node takes 16 bytes instead of the 40 used by
+// BalancedBinaryTree.
+template <typename T> class CompactBalancedBinaryTree {
+private:
+    static const uint32_t NIL = UINT32_MAX;
 
-        // Balance the node if it has become unbalanced
+    struct Node {
+        T data;
+        uint32_t left;
+        uint32_t right;
+        int8_t height;
+
+        Node(const T& value) : data(value), left(NIL), right(NIL), height(1) {}
+    };
+
+    vector<Node> pool;
+    uint32_t root;
+    uint32_t freeList; // removed nodes, chained through left
+    size_t sz;
+
+    int height(uint32_t node) const
+    {
+        return node == NIL ? 0 : pool[node].height;
+    }
 
-        // Left Left Case
-        if (balance > 1 && balanceFactor(node->left) >= 0)
-            return rotateRight(node);
+    // Node access for AvlBalancing
+    struct Access {
+        using Ref = uint32_t;
+        static const uint32_t NIL = CompactBalancedBinaryTree::NIL;
 
-        // Left Right Case
-        if (balance > 1 && balanceFactor(node->left) < 0) {
-            node->left = rotateLeft(node->left);
-            return rotateRight(node);
+        CompactBalancedBinaryTree* tree;
+
+        uint32_t root() const { return tree->root; }
+        void setRoot(uint32_t node) { tree->root = node; }
+
+        uint32_t left(uint32_t node) const { return tree->pool[node].left; }
+        uint32_t right(uint32_t node) const { return tree->pool[node].right; }
+        void setLeft(uint32_t node, uint32_t child) { tree->pool[node].left = child; }
+        void setRight(uint32_t node, uint32_t child) { tree->pool[node].right = child; }
+
+        int height(uint32_t node) const { return tree->height(node); }
+        void update(uint32_t node)
+        {
+            Node& n = tree->pool[node];
+            n.height = (int8_t)(1 + max(height(n.left), height(n.right)));
         }
+        int snapshot(uint32_t node) const { return tree->pool[node].height; }
 
-        // Right Right Case
-        if (balance < -1 && balanceFactor(node->right) <= 0)
-            return rotateLeft(node);
+        const T& data(uint32_t node) const { return tree->pool[node].data; }
+        void moveData(uint32_t to, uint32_t from) { tree->pool[to].data = std::move(tree->pool[from].data); }
+        uint32_t allocate(const T& key) { return tree->allocate(key); }
+        void release(uint32_t node) { tree->release(node); }
+    };
+
+    using Balancing = AvlBalancing<Access>;
 
-        // Right Left Case
-        if (balance < -1
-            && balanceFactor(node->right) > 0) {
-            node->right = rotateRight(node->right);
-            return rotateLeft(node);
+    uint32_t allocate(const T& key)
+    {
+        if (freeList == NIL) {
+            pool.emplace_back(key);
+            return (uint32_t)(pool.size() - 1);
         }
 
+        uint32_t node = freeList;
+        freeList = pool[node].left;
+        pool[node] = Node(key);
         return node;
     }
 
-    // Function to search for a key in the tree
-    bool search(Node* node, T key)
+    void release(uint32_t node)
     {
-        if (!node)
-            return false;
-        if (node->data == key)
-            return true;
-        if (key < node->data)
-            return search(node->left, key);
-      
-        return search(node->right, key);
+        pool[node].left = freeList;
+        freeList = node;
     }
 
-    // Function for inorder traversal of the tree
-    void inorderTraversal(Node* node)
-    {
-        if (node)
+public:
+    class ConstIterator {
+    private:
+        const vector<Node>* pool;
+        stack<uint32_t> nodeStack;
+
+        void pushLeft(uint32_t node)
         {
-            inorderTraversal(node->left);
-            cout << node->data << " ";
-            inorderTraversal(node->right);
+            while (node != NIL) {
+                nodeStack.push(node);
+                node = (*pool)[node].left;
+            }
         }
-    }
 
-public:
-    // Constructor
-    BalancedBinaryTree() : root(nullptr) {}
+    public:
+        ConstIterator(const vector<Node>* pool = nullptr, uint32_t root = NIL) : pool(pool) { pushLeft(root); }
 
-    // Public insert function
-    void insert(T key) { root = insert(root, key); }
+        const T& operator*() const { return (*pool)[nodeStack.top()].data; }
 
-    // Public remove function
-    void remove(T key) { root = remove(root, key); }
+        ConstIterator& operator++()
+        {
+            uint32_t node = nodeStack.top();
+            nodeStack.pop();
+            pushLeft((*pool)[node].right);
+            return *this;
+        }
 
-    // Public search function
-    bool search(T key) { return search(root, key); }
+        ConstIterator operator++(int)
+        {
+            ConstIterator temp = *this;
+            ++(*this);
+            return temp;
+        }
 
-    // Public function to print the inorder traversal
-    void printInorder()
+        bool operator==(const ConstIterator& other) const { return nodeStack == other.nodeStack; }
+        bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+    };
+
+    CompactBalancedBinaryTree() : root(NIL), freeList(NIL), sz(0) {}
+
+    // Reserves pool space for n keys so that inserting them does not reallocate
+    void reserve(size_t n) { pool.reserve(n); }
+
+    bool insert(const T& key)
     {
-        inorderTraversal(root);
-        cout << endl;
+        Access access{ this };
+        if (!Balancing::insert(access, key))
+            return false;
+        ++sz;
+        return true;
     }
+
+    bool remove(const T& key)
+    {
+        Access access{ this };
+        if (!Balancing::remove(access, key))
+            return false;
+        --sz;
+        return true;
+    }
+
+    bool search(const T& key) const
+    {
+        uint32_t current = root;
+        while (current != NIL) {
+            if (key < pool[current].data)
+                current = pool[current].left;
+            else if (pool[current].data < key)
+                current = pool[current].right;
+            else
+                return true;
+        }
+        return false;
+    }
+
+    size_t size() const { return sz; }
+    bool empty() const { return sz == 0; }
+
+    // Bytes held by the pool per stored key
+    double bytesPerElement() const { return sz ? (double)pool.capacity() * sizeof(Node) / sz : 0; }
+
+    ConstIterator cbegin() const { return ConstIterator(&pool, root); }
+    ConstIterator cend() const { return ConstIterator(&pool, NIL); }
 };
 
-int main()
+// Inserts n keys in random order into both layouts, then looks up n random
+// keys of which about half are present, and prints memory per key and the
+// time per operation of each
+void compareLayouts(size_t n)
 {
+    mt19937 random(12345);
+    vector<int> keys(n);
+    for (size_t i = 0; i < n; ++i)
+        keys[i] = (int)(2 * i);
+    shuffle(keys.begin(), keys.end(), random);
+
+    vector<int> probes(n);
+    uniform_int_distribution<int> anyKey(0, (int)(2 * n));
+    for (int& probe : probes)
+        probe = anyKey(random);
+
+    BalancedBinaryTree<int> pointerTree;
+    CompactBalancedBinaryTree<int> compactTree;
+    compactTree.reserve(n);
+
+    double pointerInsert = timeSeconds([&] {
+        for (int key : keys)
+            pointerTree.insert(key);
+    });
+    double compactInsert = timeSeconds([&] {
+        for (int key : keys)
+            compactTree.insert(key);
+    });
+
+    size_t pointerFound = 0;
+    size_t compactFound = 0;
+    double pointerLookup = timeSeconds([&] {
+        for (int probe : probes)
+            pointerFound += pointerTree.search(probe);
+    });
+    double compactLookup = timeSeconds([&] {
+        for (int probe : probes)
+            compactFound += compactTree.search(probe);
+    });
+
+    cout << n << " keys, " << pointerFound << " of " << n << " lookups found"
+         << (pointerFound == compactFound ? "" : " (MISMATCH)") << endl;
+    cout << "BalancedBinaryTree:        " << BalancedBinaryTree<int>::bytesPerNode()
+         << " bytes per key + allocator overhead, insert "
+         << pointerInsert * 1e9 / n << " ns, lookup " << pointerLookup * 1e9 / n << " ns" << endl;
+    cout << "CompactBalancedBinaryTree: " << compactTree.bytesPerElement()
+         << " bytes per key, insert "
+         << compactInsert * 1e9 / n << " ns, lookup " << compactLookup * 1e9 / n << " ns" << endl;
+}
+
+// Run with --benchmark [n] to compare the two node layouts on n keys
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        compareLayouts(argc > 2 ? stoul(argv[2]) : 1000000);
+        return 0;
+    }
+
     BalancedBinaryTree<int> tree;
 
     // Insert elements
@@ -262,7 +917,9 @@ int main()
     cout << "Inorder traversal of the constructed Balanced "
             "Binary Tree"
          << endl;
-    tree.printInorder();
+    for (auto it = tree.cbegin(); it != tree.cend(); ++it)
+        cout << *it << " ";
+    cout << endl;
 
     // Search for a key
     int searchKey = 30;
@@ -275,7 +932,60 @@ int main()
     tree.remove(removeKey);
     cout << "Inorder traversal after removing " << removeKey
          << ": ";
-    tree.printInorder();
+    for (auto it = tree.cbegin(); it != tree.cend(); ++it)
+        cout << *it << " ";
+    cout << endl;
+
+    // Bulk load and batch insert
+    vector<int> sortedKeys;
+    for (int i = 0; i < 20; i += 2)
+        sortedKeys.push_back(i);
+    BalancedBinaryTree<int> bulk(sortedKeys);
+
+    vector<int> batch = { 7, 3, 21, 4, 3 };
+    size_t added = bulk.insert_batch(batch.begin(), batch.end());
+    cout << "Batch added " << added << " keys: ";
+    for (auto it = bulk.cbegin(); it != bulk.cend(); ++it)
+        cout << *it << " ";
+    cout << endl;
+
+    // Compact layout for large integer indexes
+    CompactBalancedBinaryTree<int> compact;
+    compact.reserve(1000);
+    for (int i = 0; i < 1000; ++i)
+        compact.insert(i);
+    compact.remove(500);
+    cout << "Compact tree: " << compact.size() << " keys, "
+         << compact.bytesPerElement() << " bytes per key, 500 "
+         << (compact.search(500) ? "found" : "not found") << endl;
+
+    // Interval tree over reservation times
+    BalancedBinaryTree<Interval<int>, IntervalAugmentation<int>> reservations;
+    reservations.insert({ 9, 11 });
+    reservations.insert({ 10, 12 });
+    reservations.insert({ 13, 15 });
+    reservations.insert({ 14, 18 });
+
+    cout << "Reservations overlapping [11, 13]: ";
+    reservations.overlapping(11, 13, [](const Interval<int>& i) {
+        cout << "[" << i.lo << ", " << i.hi << "] ";
+    });
+    cout << endl;
+
+    cout << "Reservations at 14: ";
+    reservations.stabbing(14, [](const Interval<int>& i) {
+        cout << "[" << i.lo << ", " << i.hi << "] ";
+    });
+    cout << endl;
+
+    // A copy answers the same queries as the original
+    BalancedBinaryTree<Interval<int>, IntervalAugmentation<int>> copied(reservations);
+    copied.insert({ 1, 20 });
+    cout << "Copy, after adding [1, 20], overlapping [16, 17]: ";
+    copied.overlapping(16, 17, [](const Interval<int>& i) {
+        cout << "[" << i.lo << ", " << i.hi << "] ";
+    });
+    cout << endl;
 
     return 0;
 }
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+// Helpers shared by the benchmark programs
+
+// Seconds taken by fn
+template<typename Function>
+double timeSeconds(Function fn)
+{
+	auto start = std::chrono::steady_clock::now();
+	fn();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Pool sizes for a scaling run: 1, 2, 4, ... below the number of cores, and
+// then every core
+inline std::vector<size_t> threadCounts()
+{
+	size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<size_t> result;
+	for (size_t t = 1; t < cores; t *= 2)
+		result.push_back(t);
+	result.push_back(cores);
+	return result;
+}
@@ -0,0 +1,593 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include "GraphTypes.h"
+#include "CsrGraph.h"
+#include "TraversalWorkspace.h"
+
+// Contraction hierarchy for repeated point-to-point queries on a static graph
+// with non-negative weights. Preprocessing removes the vertices one at a time
+// in order of importance and adds a shortcut u -> x whenever the path
+// u -> v -> x through the removed vertex v was the only shortest one. A query
+// then runs Dijkstra from both ends over edges that lead to more important
+// vertices only, which settles a few hundred vertices even on large road
+// networks, and expands the shortcuts on the result back into original edges.
+class ContractionHierarchy
+{
+public:
+
+	explicit ContractionHierarchy(const CsrGraph& g);
+
+	size_t vertexCount() const;
+	size_t shortcutCount() const;
+
+	// Same result as CsrGraph::dijkstra: the distance, or UNREACHABLE with an empty path
+	size_t query(size_t start, size_t end, std::vector<size_t>& path) const;
+	size_t query(size_t start, size_t end, std::vector<size_t>& path,
+		TraversalWorkspace& forward, TraversalWorkspace& backward) const;
+
+	// Binary dump in the native byte order and word size
+	void save(std::ostream& out) const;
+	static ContractionHierarchy load(std::istream& in);
+
+private:
+
+	static const uint32_t NO_MIDDLE = UINT32_MAX;
+	static const uint32_t FILE_MAGIC = 0x43480001;
+
+	// middle is the contracted vertex a shortcut bypasses, NO_MIDDLE for an original edge
+	struct HierarchyEdge
+	{
+		uint32_t target;
+		uint32_t middle;
+		size_t weight;
+	};
+
+	// upEdges of v: edges v -> target with rank[target] > rank[v].
+	// downEdges of v: edges target -> v with rank[target] > rank[v], which the
+	// backward search follows against their direction.
+	std::vector<uint32_t> ranks;
+	std::vector<size_t> upOffsets;
+	std::vector<HierarchyEdge> upEdges;
+	std::vector<size_t> downOffsets;
+	std::vector<HierarchyEdge> downEdges;
+
+	ContractionHierarchy() = default;
+
+	const HierarchyEdge* findEdge(size_t from, size_t to) const;
+	void unpack(size_t from, size_t to, std::vector<size_t>& path) const;
+	void validate() const;
+
+	static std::vector<size_t> flatten(std::vector<std::vector<HierarchyEdge>>& lists, std::vector<HierarchyEdge>& edges);
+};
+
+namespace ContractionDetail
+{
+	const size_t WITNESS_SETTLE_LIMIT = 500;
+
+	struct WorkEdge
+	{
+		uint32_t other;
+		uint32_t middle;
+		size_t weight;
+	};
+
+	// The remaining graph during preprocessing. Contracted vertices are erased
+	// from their neighbors' lists, and there is at most one edge per ordered pair.
+	struct WorkGraph
+	{
+		std::vector<std::vector<WorkEdge>> out;
+		std::vector<std::vector<WorkEdge>> in;
+
+		void addOrImprove(uint32_t from, uint32_t to, size_t weight, uint32_t middle)
+		{
+			for (WorkEdge& e : out[from])
+			{
+				if (e.other != to)
+					continue;
+				if (e.weight <= weight)
+					return;
+
+				e.weight = weight;
+				e.middle = middle;
+				for (WorkEdge& r : in[to])
+				{
+					if (r.other == from)
+					{
+						r.weight = weight;
+						r.middle = middle;
+					}
+				}
+				return;
+			}
+
+			out[from].push_back({ to, middle, weight });
+			in[to].push_back({ from, middle, weight });
+		}
+
+		static void eraseNeighbor(std::vector<WorkEdge>& list, uint32_t v)
+		{
+			list.erase(std::remove_if(list.begin(), list.end(), [v](const WorkEdge& e) { return e.other == v; }), list.end());
+		}
+	};
+
+	// Dijkstra from source that avoids skipped and gives up past maxDist or
+	// after WITNESS_SETTLE_LIMIT vertices. Tentative distances are lengths of
+	// real paths, so stopping early only ever adds shortcuts that were not needed.
+	inline void witnessSearch(const WorkGraph& g, uint32_t source, uint32_t skipped, size_t maxDist,
+		TraversalWorkspace& workspace)
+	{
+		using vertexAndDistancePair = std::pair<size_t, size_t>;
+		std::greater<vertexAndDistancePair> later;
+
+		workspace.reset(g.out.size());
+		std::vector<vertexAndDistancePair>& q = workspace.heap();
+		workspace.setDistance(source, 0, source);
+		q.push_back({ 0, source });
+
+		size_t settled = 0;
+		while (!q.empty() && settled < WITNESS_SETTLE_LIMIT)
+		{
+			std::pop_heap(q.begin(), q.end(), later);
+			vertexAndDistancePair current = q.back();
+			q.pop_back();
+
+			if (current.first > workspace.distance(current.second))
+				continue;
+			if (current.first > maxDist)
+				break;
+			++settled;
+
+			for (const WorkEdge& e : g.out[current.second])
+			{
+				if (e.other == skipped)
+					continue;
+
+				size_t newDist = current.first + e.weight;
+				if (newDist < workspace.distance(e.other))
+				{
+					workspace.setDistance(e.other, newDist, current.second);
+					q.push_back({ newDist, e.other });
+					std::push_heap(q.begin(), q.end(), later);
+				}
+			}
+		}
+	}
+
+	// Number of shortcuts contracting v needs; adds them unless simulate is set
+	inline size_t contract(WorkGraph& g, uint32_t v, bool simulate, TraversalWorkspace& workspace)
+	{
+		size_t shortcuts = 0;
+
+		// Shortcuts only touch the lists of v's neighbors, never v's own
+		const std::vector<WorkEdge>& incoming = g.in[v];
+		const std::vector<WorkEdge>& outgoing = g.out[v];
+
+		for (const WorkEdge& in : incoming)
+		{
+			size_t maxOut = 0;
+			bool hasTarget = false;
+			for (const WorkEdge& out : outgoing)
+			{
+				if (out.other != in.other)
+				{
+					maxOut = std::max(maxOut, out.weight);
+					hasTarget = true;
+				}
+			}
+			if (!hasTarget)
+				continue;
+
+			witnessSearch(g, in.other, v, in.weight + maxOut, workspace);
+
+			for (const WorkEdge& out : outgoing)
+			{
+				if (out.other == in.other)
+					continue;
+
+				size_t viaV = in.weight + out.weight;
+				if (workspace.distance(out.other) <= viaV)
+					continue;
+
+				++shortcuts;
+				if (!simulate)
+					g.addOrImprove(in.other, out.other, viaV, v);
+			}
+		}
+
+		return shortcuts;
+	}
+}
+
+// Vertices are contracted in increasing order of edge difference (shortcuts
+// added minus edges removed) plus the number of already contracted neighbors,
+// which spreads the contraction evenly over the graph. Priorities go stale as
+// the graph changes, so a popped vertex is re-evaluated and put back if it is
+// no longer the minimum. When v is contracted its remaining edges all lead to
+// more important vertices, so they are final and become v's hierarchy edges.
+inline ContractionHierarchy::ContractionHierarchy(const CsrGraph& g)
+{
+	using namespace ContractionDetail;
+
+	size_t V = g.vertexCount();
+	WorkGraph work;
+	work.out.resize(V);
+	work.in.resize(V);
+
+	for (size_t v = 0; v < V; ++v)
+	{
+		for (size_t i = g.edgesBegin(v); i < g.edgesEnd(v); ++i)
+		{
+			if (g.target(i) != v)
+				work.addOrImprove((uint32_t)v, (uint32_t)g.target(i), g.weight(i), NO_MIDDLE);
+		}
+	}
+
+	TraversalWorkspace workspace(V);
+	std::vector<size_t> contractedNeighbors(V, 0);
+	std::vector<size_t> levels(V, 0);
+
+	auto priority = [&](uint32_t v) {
+		long long shortcuts = (long long)contract(work, v, true, workspace);
+		long long removed = (long long)(work.in[v].size() + work.out[v].size());
+		return shortcuts - removed + (long long)contractedNeighbors[v] + (long long)levels[v];
+	};
+
+	using priorityAndVertexPair = std::pair<long long, uint32_t>;
+	std::priority_queue<priorityAndVertexPair, std::vector<priorityAndVertexPair>, std::greater<priorityAndVertexPair>> order;
+	for (size_t v = 0; v < V; ++v)
+		order.push({ priority((uint32_t)v), (uint32_t)v });
+
+	ranks.assign(V, 0);
+	std::vector<std::vector<HierarchyEdge>> up(V), down(V);
+	uint32_t nextRank = 0;
+
+	while (!order.empty())
+	{
+		uint32_t v = order.top().second;
+		order.pop();
+
+		long long current = priority(v);
+		if (!order.empty() && current > order.top().first)
+		{
+			order.push({ current, v });
+			continue;
+		}
+
+		contract(work, v, false, workspace);
+		ranks[v] = nextRank++;
+
+		for (const WorkEdge& e : work.out[v])
+		{
+			up[v].push_back({ e.other, e.middle, e.weight });
+			WorkGraph::eraseNeighbor(work.in[e.other], v);
+			contractedNeighbors[e.other]++;
+			levels[e.other] = std::max(levels[e.other], levels[v] + 1);
+		}
+
+		for (const WorkEdge& e : work.in[v])
+		{
+			down[v].push_back({ e.other, e.middle, e.weight });
+			WorkGraph::eraseNeighbor(work.out[e.other], v);
+			contractedNeighbors[e.other]++;
+			levels[e.other] = std::max(levels[e.other], levels[v] + 1);
+		}
+
+		std::vector<WorkEdge>().swap(work.out[v]);
+		std::vector<WorkEdge>().swap(work.in[v]);
+	}
+
+	upOffsets = flatten(up, upEdges);
+	downOffsets = flatten(down, downEdges);
+}
+
+inline std::vector<size_t> ContractionHierarchy::flatten(std::vector<std::vector<HierarchyEdge>>& lists, std::vector<HierarchyEdge>& edges)
+{
+	std::vector<size_t> offsets(lists.size() + 1, 0);
+	for (size_t v = 0; v < lists.size(); ++v)
+		offsets[v + 1] = offsets[v] + lists[v].size();
+
+	edges.reserve(offsets.back());
+	for (std::vector<HierarchyEdge>& list : lists)
+	{
+		edges.insert(edges.end(), list.begin(), list.end());
+		std::vector<HierarchyEdge>().swap(list);
+	}
+
+	return offsets;
+}
+
+inline size_t ContractionHierarchy::vertexCount() const
+{
+	return ranks.size();
+}
+
+inline size_t ContractionHierarchy::shortcutCount() const
+{
+	size_t count = 0;
+	for (const HierarchyEdge& e : upEdges)
+		count += e.middle != NO_MIDDLE;
+	for (const HierarchyEdge& e : downEdges)
+		count += e.middle != NO_MIDDLE;
+	return count;
+}
+
+inline size_t ContractionHierarchy::query(size_t start, size_t end, std::vector<size_t>& path) const
+{
+	TraversalWorkspace forward(vertexCount()), backward(vertexCount());
+	return query(start, end, path, forward, backward);
+}
+
+// Both searches only climb the hierarchy, and every shortest path has a
+// highest vertex that both of them reach with its exact distance. A side is
+// done once its heap minimum reaches the best distance found, since climbing
+// further can only add weight.
+inline size_t ContractionHierarchy::query(size_t start, size_t end, std::vector<size_t>& path,
+	TraversalWorkspace& forward, TraversalWorkspace& backward) const
+{
+	// (distance, vertex), smallest distance on top
+	using vertexAndDistancePair = std::pair<size_t, size_t>;
+	std::greater<vertexAndDistancePair> later;
+
+	size_t V = vertexCount();
+	forward.reset(V);
+	backward.reset(V);
+	std::vector<vertexAndDistancePair>& forwardQueue = forward.heap();
+	std::vector<vertexAndDistancePair>& backwardQueue = backward.heap();
+
+	forward.setDistance(start, 0, start);
+	backward.setDistance(end, 0, end);
+	forwardQueue.push_back({ 0, start });
+	backwardQueue.push_back({ 0, end });
+
+	size_t best = start == end ? 0 : UNREACHABLE;
+	size_t meet = start;
+
+	while (true)
+	{
+		bool forwardDone = forwardQueue.empty() || forwardQueue.front().first >= best;
+		bool backwardDone = backwardQueue.empty() || backwardQueue.front().first >= best;
+		if (forwardDone && backwardDone)
+			break;
+
+		bool isForward = !forwardDone && (backwardDone || forwardQueue.front().first <= backwardQueue.front().first);
+		TraversalWorkspace& side = isForward ? forward : backward;
+		const TraversalWorkspace& other = isForward ? backward : forward;
+		std::vector<vertexAndDistancePair>& q = isForward ? forwardQueue : backwardQueue;
+		const std::vector<size_t>& offsets = isForward ? upOffsets : downOffsets;
+		const std::vector<HierarchyEdge>& edges = isForward ? upEdges : downEdges;
+
+		std::pop_heap(q.begin(), q.end(), later);
+		vertexAndDistancePair current = q.back();
+		q.pop_back();
+
+		size_t currentVertex = current.second;
+		if (current.first > side.distance(currentVertex))
+			continue;
+
+		for (size_t i = offsets[currentVertex]; i < offsets[currentVertex + 1]; ++i)
+		{
+			size_t currentNeighbor = edges[i].target;
+
+			size_t newDist = current.first + edges[i].weight;
+			if (newDist < side.distance(currentNeighbor))
+			{
+				side.setDistance(currentNeighbor, newDist, currentVertex);
+				q.push_back({ newDist, currentNeighbor });
+				std::push_heap(q.begin(), q.end(), later);
+
+				size_t otherDist = other.distance(currentNeighbor);
+				if (otherDist != UNREACHABLE && newDist + otherDist < best)
+				{
+					best = newDist + otherDist;
+					meet = currentNeighbor;
+				}
+			}
+		}
+	}
+
+	if (best == UNREACHABLE)
+		return UNREACHABLE;
+
+	std::vector<size_t> hierarchyPath;
+	for (size_t v = meet; v != start; v = forward.parent(v))
+		hierarchyPath.push_back(v);
+	hierarchyPath.push_back(start);
+	std::reverse(hierarchyPath.begin(), hierarchyPath.end());
+
+	for (size_t v = meet; v != end; )
+	{
+		v = backward.parent(v);
+		hierarchyPath.push_back(v);
+	}
+
+	path.push_back(start);
+	for (size_t i = 0; i + 1 < hierarchyPath.size(); ++i)
+		unpack(hierarchyPath[i], hierarchyPath[i + 1], path);
+
+	return best;
+}
+
+// The edge from -> to is stored with whichever endpoint has the lower rank.
+// Null if there is no such edge.
+inline const ContractionHierarchy::HierarchyEdge* ContractionHierarchy::findEdge(size_t from, size_t to) const
+{
+	bool isUp = ranks[from] < ranks[to];
+	size_t owner = isUp ? from : to;
+	size_t other = isUp ? to : from;
+	const std::vector<size_t>& offsets = isUp ? upOffsets : downOffsets;
+	const std::vector<HierarchyEdge>& edges = isUp ? upEdges : downEdges;
+
+	for (size_t i = offsets[owner]; i < offsets[owner + 1]; ++i)
+	{
+		if (edges[i].target == other)
+			return &edges[i];
+	}
+	return nullptr;
+}
+
+// A shortcut from -> to through m stands for the edges from -> m and m -> to,
+// both stored at m since m was contracted first. Expands with an explicit
+// stack and appends everything after from to path.
+inline void ContractionHierarchy::unpack(size_t from, size_t to, std::vector<size_t>& path) const
+{
+	std::vector<std::pair<size_t, size_t>> pending;
+	pending.push_back({ from, to });
+
+	while (!pending.empty())
+	{
+		std::pair<size_t, size_t> current = pending.back();
+		pending.pop_back();
+
+		const HierarchyEdge& e = *findEdge(current.first, current.second);
+		if (e.middle == NO_MIDDLE)
+		{
+			path.push_back(current.second);
+			continue;
+		}
+
+		pending.push_back({ e.middle, current.second });
+		pending.push_back({ current.first, e.middle });
+	}
+}
+
+namespace ContractionDetail
+{
+	template<typename T>
+	void writeVector(std::ostream& out, const std::vector<T>& data)
+	{
+		size_t size = data.size();
+		out.write((const char*)&size, sizeof(size));
+		out.write((const char*)data.data(), sizeof(T) * size);
+	}
+
+	// Bytes left in a seekable stream, SIZE_MAX when the stream cannot tell
+	inline size_t remainingBytes(std::istream& in)
+	{
+		std::streampos current = in.tellg();
+		if (current == std::streampos(-1))
+			return SIZE_MAX;
+
+		in.seekg(0, std::ios::end);
+		std::streampos end = in.tellg();
+		in.seekg(current);
+		return end == std::streampos(-1) ? SIZE_MAX : (size_t)(end - current);
+	}
+
+	// The stored size is checked against what the stream still holds, and the
+	// data is read in blocks, so a corrupted size fails as a truncated file
+	// instead of allocating whatever it claims
+	template<typename T>
+	void readVector(std::istream& in, std::vector<T>& data)
+	{
+		const size_t BLOCK = (1 << 20) / sizeof(T) + 1;
+
+		size_t size = 0;
+		if (!in.read((char*)&size, sizeof(size)) || size > remainingBytes(in) / sizeof(T))
+			throw std::runtime_error("Truncated contraction hierarchy file!");
+
+		data.clear();
+		while (data.size() < size)
+		{
+			size_t done = data.size();
+			data.resize(done + std::min(BLOCK, size - done));
+			if (!in.read((char*)(data.data() + done), sizeof(T) * (data.size() - done)))
+				throw std::runtime_error("Truncated contraction hierarchy file!");
+		}
+	}
+}
+
+inline void ContractionHierarchy::save(std::ostream& out) const
+{
+	uint32_t magic = FILE_MAGIC;
+	out.write((const char*)&magic, sizeof(magic));
+
+	ContractionDetail::writeVector(out, ranks);
+	ContractionDetail::writeVector(out, upOffsets);
+	ContractionDetail::writeVector(out, upEdges);
+	ContractionDetail::writeVector(out, downOffsets);
+	ContractionDetail::writeVector(out, downEdges);
+}
+
+inline ContractionHierarchy ContractionHierarchy::load(std::istream& in)
+{
+	uint32_t magic = 0;
+	if (!in.read((char*)&magic, sizeof(magic)) || magic != FILE_MAGIC)
+		throw std::runtime_error("Not a contraction hierarchy file!");
+
+	ContractionHierarchy result;
+	ContractionDetail::readVector(in, result.ranks);
+	ContractionDetail::readVector(in, result.upOffsets);
+	ContractionDetail::readVector(in, result.upEdges);
+	ContractionDetail::readVector(in, result.downOffsets);
+	ContractionDetail::readVector(in, result.downEdges);
+
+	result.validate();
+	return result;
+}
+
+// Checks everything query() relies on, so that a corrupted file is rejected
+// by load() instead of sending a query out of bounds: ranks are a permutation,
+// offsets are monotone and cover the edge arrays, edges lead to vertices of
+// higher rank, and every shortcut bypasses a lower-ranked vertex whose two
+// halves are stored. The rank of the lower endpoint drops with every expansion,
+// so unpacking a validated shortcut always ends.
+inline void ContractionHierarchy::validate() const
+{
+	const char* corrupted = "Corrupted contraction hierarchy file!";
+	size_t V = ranks.size();
+
+	std::vector<bool> seen(V, false);
+	for (uint32_t rank : ranks)
+	{
+		if (rank >= V || seen[rank])
+			throw std::runtime_error(corrupted);
+		seen[rank] = true;
+	}
+
+	for (bool isUp : { true, false })
+	{
+		const std::vector<size_t>& offsets = isUp ? upOffsets : downOffsets;
+		const std::vector<HierarchyEdge>& edges = isUp ? upEdges : downEdges;
+
+		if (offsets.size() != V + 1 || offsets[0] != 0 || offsets.back() != edges.size())
+			throw std::runtime_error(corrupted);
+		for (size_t v = 0; v < V; ++v)
+		{
+			if (offsets[v] > offsets[v + 1])
+				throw std::runtime_error(corrupted);
+		}
+	}
+
+	// findEdge below reads the offsets of any vertex, so they are all checked first
+	for (bool isUp : { true, false })
+	{
+		const std::vector<size_t>& offsets = isUp ? upOffsets : downOffsets;
+		const std::vector<HierarchyEdge>& edges = isUp ? upEdges : downEdges;
+
+		for (size_t v = 0; v < V; ++v)
+		{
+			for (size_t i = offsets[v]; i < offsets[v + 1]; ++i)
+			{
+				const HierarchyEdge& e = edges[i];
+				if (e.target >= V || ranks[e.target] <= ranks[v])
+					throw std::runtime_error(corrupted);
+				if (e.middle == NO_MIDDLE)
+					continue;
+
+				size_t from = isUp ? v : e.target;
+				size_t to = isUp ? e.target : v;
+				if (e.middle >= V || ranks[e.middle] >= ranks[v]
+					|| !findEdge(from, e.middle) || !findEdge(e.middle, to))
+					throw std::runtime_error(corrupted);
+			}
+		}
+	}
+}
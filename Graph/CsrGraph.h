@@ -0,0 +1,432 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <stack>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include "GraphTypes.h"
+#include "../Disjoint Set/UnionByHeight/UnionFind.h"
+
+// Compressed sparse row graph. The neighbors of v are targets[offsets[v]] ..
+// targets[offsets[v + 1] - 1], with the matching weights at the same positions,
+// so the whole adjacency is three flat arrays and a scan of a neighbor list is
+// a sequential read. Vertex ids must fit in 32 bits.
+class CsrGraph
+{
+public:
+
+	CsrGraph(size_t vertexCount, const std::vector<Edge>& edges, bool isOriented);
+	// Takes over arrays that are already in CSR form: offsets has
+	// vertexCount + 1 entries, and an unoriented graph stores every edge in
+	// both directions.
+	CsrGraph(std::vector<size_t> offsets, std::vector<uint32_t> targets, std::vector<int> weights, bool isOriented);
+
+	size_t vertexCount() const;
+	size_t edgeCount() const;
+	bool isOriented() const;
+
+	// Positions of v's neighbors in the target/weight arrays
+	size_t edgesBegin(size_t v) const;
+	size_t edgesEnd(size_t v) const;
+	size_t target(size_t i) const;
+	int weight(size_t i) const;
+
+	std::vector<size_t> BFS(size_t start) const;
+	std::vector<size_t> DFS(size_t start) const;
+	size_t dijkstra(size_t start, size_t end, std::vector<size_t>& path) const;
+	MST Prim() const;
+	MST Kruskal() const;
+	bool containsCycle() const;
+	std::vector<size_t> topoSort() const;
+
+private:
+
+	std::vector<size_t> offsets;
+	std::vector<uint32_t> targets;
+	std::vector<int> weights;
+	bool oriented;
+};
+
+// Counting sort by start vertex: count the out-degrees, turn the counts into
+// offsets with a prefix sum, then drop every edge into its vertex's slot.
+inline CsrGraph::CsrGraph(size_t vertexCount, const std::vector<Edge>& edges, bool isOriented)
+	: offsets(vertexCount + 1, 0), oriented(isOriented)
+{
+	for (const Edge& e : edges)
+	{
+		offsets[std::get<0>(e) + 1]++;
+		if (!oriented)
+			offsets[std::get<1>(e) + 1]++;
+	}
+
+	for (size_t v = 0; v < vertexCount; ++v)
+		offsets[v + 1] += offsets[v];
+
+	targets.resize(offsets[vertexCount]);
+	weights.resize(offsets[vertexCount]);
+
+	std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+	for (const Edge& e : edges)
+	{
+		size_t start = std::get<0>(e);
+		size_t end = std::get<1>(e);
+
+		targets[next[start]] = (uint32_t)end;
+		weights[next[start]++] = std::get<2>(e);
+
+		if (!oriented)
+		{
+			targets[next[end]] = (uint32_t)start;
+			weights[next[end]++] = std::get<2>(e);
+		}
+	}
+}
+
+inline CsrGraph::CsrGraph(std::vector<size_t> offsets, std::vector<uint32_t> targets, std::vector<int> weights, bool isOriented)
+	: offsets(std::move(offsets)), targets(std::move(targets)), weights(std::move(weights)), oriented(isOriented)
+{
+	if (this->offsets.empty() || this->offsets.back() != this->targets.size() || this->targets.size() != this->weights.size())
+		throw std::runtime_error("Inconsistent CSR arrays!");
+}
+
+inline size_t CsrGraph::vertexCount() const
+{
+	return offsets.size() - 1;
+}
+
+inline size_t CsrGraph::edgeCount() const
+{
+	return targets.size();
+}
+
+inline bool CsrGraph::isOriented() const
+{
+	return oriented;
+}
+
+inline size_t CsrGraph::edgesBegin(size_t v) const
+{
+	return offsets[v];
+}
+
+inline size_t CsrGraph::edgesEnd(size_t v) const
+{
+	return offsets[v + 1];
+}
+
+inline size_t CsrGraph::target(size_t i) const
+{
+	return targets[i];
+}
+
+inline int CsrGraph::weight(size_t i) const
+{
+	return weights[i];
+}
+
+// Returns the vertices reachable from start in BFS order
+inline std::vector<size_t> CsrGraph::BFS(size_t start) const
+{
+	std::vector<bool> visited(vertexCount(), false);
+	std::vector<size_t> order;
+
+	order.push_back(start);
+	visited[start] = true;
+
+	// order doubles as the queue: everything after head is still to be expanded
+	for (size_t head = 0; head < order.size(); ++head)
+	{
+		size_t current = order[head];
+		for (size_t i = offsets[current]; i < offsets[current + 1]; ++i)
+		{
+			size_t neighbor = targets[i];
+			if (visited[neighbor])
+				continue;
+
+			visited[neighbor] = true;
+			order.push_back(neighbor);
+		}
+	}
+
+	return order;
+}
+
+// Returns the vertices reachable from start in DFS preorder
+inline std::vector<size_t> CsrGraph::DFS(size_t start) const
+{
+	std::vector<bool> visited(vertexCount(), false);
+	std::vector<size_t> order;
+
+	// (vertex, position of the next neighbor to look at)
+	std::stack<std::pair<size_t, size_t>> s;
+	s.push({ start, offsets[start] });
+	visited[start] = true;
+	order.push_back(start);
+
+	while (!s.empty())
+	{
+		auto& top = s.top();
+		if (top.second == offsets[top.first + 1])
+		{
+			s.pop();
+			continue;
+		}
+
+		size_t neighbor = targets[top.second++];
+		if (visited[neighbor])
+			continue;
+
+		visited[neighbor] = true;
+		order.push_back(neighbor);
+		s.push({ neighbor, offsets[neighbor] });
+	}
+
+	return order;
+}
+
+inline size_t CsrGraph::dijkstra(size_t start, size_t end, std::vector<size_t>& path) const
+{
+	struct vertexAndDistancePair
+	{
+		size_t vertex;
+		size_t distFromStart;
+
+		bool operator<(const vertexAndDistancePair& other) const
+		{
+			return distFromStart > other.distFromStart;
+		}
+	};
+
+	std::vector<size_t> distances(vertexCount(), INT_MAX);
+	std::vector<size_t> prevs(vertexCount());
+	std::priority_queue<vertexAndDistancePair> q;
+
+	distances[start] = 0;
+	q.push({ start, 0 });
+
+	while (!q.empty())
+	{
+		vertexAndDistancePair current = q.top();
+		q.pop();
+
+		if (current.distFromStart > distances[current.vertex])
+			continue;
+
+		if (current.vertex == end)
+		{
+			while (end != start)
+			{
+				path.push_back(end);
+				end = prevs[end];
+			}
+
+			path.push_back(start);
+			std::reverse(path.begin(), path.end());
+
+			return distances[current.vertex];
+		}
+
+		for (size_t i = offsets[current.vertex]; i < offsets[current.vertex + 1]; ++i)
+		{
+			size_t currentNeighbor = targets[i];
+
+			size_t newDist = current.distFromStart + weights[i];
+			if (newDist < distances[currentNeighbor])
+			{
+				distances[currentNeighbor] = newDist;
+				q.push({ currentNeighbor, newDist });
+				prevs[currentNeighbor] = current.vertex;
+			}
+		}
+	}
+
+	return INT_MAX;
+}
+
+inline MST CsrGraph::Prim() const
+{
+	struct primEdge
+	{
+		size_t start;
+		size_t end;
+		int weight;
+
+		bool operator<(const primEdge& other) const
+		{
+			return weight > other.weight;
+		}
+	};
+
+	MST result;
+	result.sumOfWeights = 0;
+	if (vertexCount() == 0)
+		return result;
+
+	std::priority_queue<primEdge> q;
+	std::vector<bool> visited(vertexCount());
+	q.push({ 0, 0, 0 });
+	bool isFirst = true;
+
+	while (result.edges.size() + 1 < vertexCount() && !q.empty())
+	{
+		primEdge current = q.top();
+		q.pop();
+
+		if (visited[current.end])
+			continue;
+
+		visited[current.end] = true;
+		for (size_t i = offsets[current.end]; i < offsets[current.end + 1]; ++i)
+		{
+			if (!visited[targets[i]])
+				q.push({ current.end, targets[i], weights[i] });
+		}
+
+		if (isFirst)
+		{
+			isFirst = false;
+			continue;
+		}
+
+		result.edges.push_back({ current.start, current.end, current.weight });
+		result.sumOfWeights += current.weight;
+	}
+
+	return result;
+}
+
+inline MST CsrGraph::Kruskal() const
+{
+	MST result;
+	result.sumOfWeights = 0;
+
+	// An undirected edge is stored at both endpoints; keep one copy.
+	std::vector<Edge> edges;
+	for (size_t v = 0; v < vertexCount(); ++v)
+	{
+		for (size_t i = offsets[v]; i < offsets[v + 1]; ++i)
+		{
+			if (oriented || v < targets[i])
+				edges.push_back({ v, targets[i], weights[i] });
+		}
+	}
+
+	std::sort(edges.begin(), edges.end(), [](const Edge& lhs, const Edge& rhs) {
+		return std::get<2>(lhs) < std::get<2>(rhs);
+		});
+
+	UnionFind uf((int)vertexCount());
+	for (size_t i = 0; i < edges.size() && result.edges.size() + 1 < vertexCount(); ++i)
+	{
+		const Edge& e = edges[i];
+		if (uf.Union((int)std::get<0>(e), (int)std::get<1>(e)))
+		{
+			result.edges.push_back(e);
+			result.sumOfWeights += std::get<2>(e);
+		}
+	}
+
+	return result;
+}
+
+// DFS with an explicit stack, so path length is not limited by the call
+// stack. An edge to a vertex that is still open closes a cycle. An undirected
+// graph stores every edge at both ends, so each vertex skips the one copy
+// that leads back to its DFS parent; a second edge to the parent is a real
+// cycle of length two.
+inline bool CsrGraph::containsCycle() const
+{
+	enum Color : uint8_t { White, Gray, Black };
+	struct Frame
+	{
+		size_t vertex;
+		size_t next;
+		size_t parent;
+		bool parentEdgeSkipped;
+	};
+
+	std::vector<Color> color(vertexCount(), White);
+	std::stack<Frame> s;
+
+	for (size_t root = 0; root < vertexCount(); ++root)
+	{
+		if (color[root] != White)
+			continue;
+
+		color[root] = Gray;
+		s.push({ root, offsets[root], SIZE_MAX, false });
+
+		while (!s.empty())
+		{
+			Frame& top = s.top();
+			if (top.next == offsets[top.vertex + 1])
+			{
+				color[top.vertex] = Black;
+				s.pop();
+				continue;
+			}
+
+			size_t neighbor = targets[top.next++];
+			if (!oriented && neighbor == top.parent && !top.parentEdgeSkipped)
+			{
+				top.parentEdgeSkipped = true;
+				continue;
+			}
+
+			if (color[neighbor] == Gray)
+				return true;
+			if (color[neighbor] == White)
+			{
+				color[neighbor] = Gray;
+				s.push({ neighbor, offsets[neighbor], top.vertex, false });
+			}
+		}
+	}
+
+	return false;
+}
+
+// Reverse DFS postorder, with an explicit stack. Only oriented graphs have a
+// topological order; on a graph with a cycle the result is not one.
+inline std::vector<size_t> CsrGraph::topoSort() const
+{
+	if (!oriented)
+		throw std::runtime_error("Topological sort needs an oriented graph!");
+
+	std::vector<bool> visited(vertexCount(), false);
+	std::vector<size_t> result;
+	std::stack<std::pair<size_t, size_t>> s;
+
+	for (size_t root = 0; root < vertexCount(); ++root)
+	{
+		if (visited[root])
+			continue;
+
+		visited[root] = true;
+		s.push({ root, offsets[root] });
+
+		while (!s.empty())
+		{
+			auto& top = s.top();
+			if (top.second == offsets[top.first + 1])
+			{
+				result.push_back(top.first);
+				s.pop();
+				continue;
+			}
+
+			size_t neighbor = targets[top.second++];
+			if (!visited[neighbor])
+			{
+				visited[neighbor] = true;
+				s.push({ neighbor, offsets[neighbor] });
+			}
+		}
+	}
+
+	std::reverse(result.begin(), result.end());
+	return result;
+}
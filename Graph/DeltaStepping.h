@@ -0,0 +1,216 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include "GraphTypes.h"
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+// Delta-stepping single-source shortest paths (Meyer and Sanders). Vertices
+// are kept in buckets of width delta by tentative distance, and a whole bucket
+// is relaxed in parallel instead of one vertex at a time. Light edges
+// (weight <= delta) can put vertices back into the current bucket, so they are
+// relaxed until the bucket stays empty; heavy edges always leave the bucket and
+// are relaxed once afterwards from every vertex the bucket settled. Distances
+// are lowered with a compare-and-swap loop, and the thread that lowers one
+// files the vertex in its own bins, so the only shared writes are the
+// distances. Weights must be non-negative.
+//
+// Buckets are kept in a ring of at most MAX_BINS bins, enough for every
+// bucket a relaxation can reach when maxWeight / delta < MAX_BINS - 1. With a
+// smaller delta the ring covers only the next MAX_BINS buckets; vertices
+// beyond it wait in an overflow list, which is filtered back into the ring
+// when the search reaches its nearest bucket, at most once per MAX_BINS
+// buckets. Memory is O(V + E + MAX_BINS * threads) for any delta.
+//
+// Only the distances are returned: with zero-weight edges, concurrent updates
+// could leave predecessors that form a cycle. delta == 0 picks the maximum
+// weight divided by the average degree. An empty graph gives no distances;
+// any other graph needs a source below vertexCount().
+inline std::vector<size_t> deltaStepping(const CsrGraph& g, size_t source, ThreadPool& pool, size_t delta = 0)
+{
+	const size_t GRAIN = 64;
+	const size_t MAX_BINS = 4096;
+	size_t V = g.vertexCount();
+	size_t threads = pool.size();
+
+	if (V == 0)
+		return {};
+	if (source >= V)
+		throw std::runtime_error("Source vertex out of range!");
+
+	std::vector<size_t> threadMax(threads, 0);
+	pool.parallelFor(V, 1024, [&](size_t begin, size_t end, size_t thread) {
+		for (size_t i = g.edgesBegin(begin); i < g.edgesEnd(end - 1); ++i)
+			threadMax[thread] = std::max(threadMax[thread], (size_t)g.weight(i));
+	});
+	size_t maxWeight = *std::max_element(threadMax.begin(), threadMax.end());
+
+	if (delta == 0)
+	{
+		size_t averageDegree = V == 0 ? 1 : std::max<size_t>(g.edgeCount() / V, 1);
+		delta = std::max<size_t>(maxWeight / averageDegree, 1);
+	}
+
+	// Every pending distance is less than (current + 1) * delta + maxWeight,
+	// so with this many bins used as a ring no bin holds two different
+	// buckets; past MAX_BINS the far buckets go to the overflow list instead.
+	size_t binCount = std::min(maxWeight / delta + 2, MAX_BINS);
+
+	std::vector<std::atomic<size_t>> distances(V);
+	pool.parallelFor(V, 1024, [&](size_t begin, size_t end, size_t) {
+		for (size_t v = begin; v < end; ++v)
+			distances[v].store(UNREACHABLE, std::memory_order_relaxed);
+	});
+
+	// occupied[b] is set once some thread has filed a vertex in bin b, so
+	// looking for the next bucket reads one flag per bin instead of every
+	// thread's list
+	std::vector<std::vector<std::vector<uint32_t>>> bins(threads, std::vector<std::vector<uint32_t>>(binCount));
+	std::vector<std::atomic<uint8_t>> occupied(binCount);
+	for (auto& flag : occupied)
+		flag.store(0, std::memory_order_relaxed);
+	std::vector<std::vector<uint32_t>> overflow(threads);
+	std::vector<size_t> overflowFirst(threads, SIZE_MAX); // lowest bucket filed in overflow[t]
+	std::vector<std::vector<uint32_t>> settled(threads);
+	std::vector<size_t> offsets(threads + 1);
+	size_t bucket = 0;
+
+	// Files v in the ring when its bucket is among the binCount buckets from
+	// the current one, and in the overflow list otherwise
+	auto file = [&](uint32_t v, size_t target, size_t thread) {
+		if (target - bucket < binCount)
+		{
+			size_t bin = target % binCount;
+			bins[thread][bin].push_back(v);
+			if (!occupied[bin].load(std::memory_order_relaxed))
+				occupied[bin].store(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			overflow[thread].push_back(v);
+			overflowFirst[thread] = std::min(overflowFirst[thread], target);
+		}
+	};
+
+	auto relax = [&](size_t v, size_t newDist, size_t thread) {
+		size_t old = distances[v].load(std::memory_order_relaxed);
+		while (newDist < old)
+		{
+			if (distances[v].compare_exchange_weak(old, newDist, std::memory_order_relaxed))
+			{
+				file((uint32_t)v, newDist / delta, thread);
+				return;
+			}
+		}
+	};
+
+	// Moves the per-thread lists part(t) into out, in parallel
+	auto gather = [&](std::vector<uint32_t>& out, auto part) {
+		for (size_t t = 0; t < threads; ++t)
+			offsets[t + 1] = offsets[t] + part(t).size();
+
+		out.resize(offsets.back());
+		pool.parallelFor(threads, 1, [&](size_t begin, size_t end, size_t) {
+			for (size_t t = begin; t < end; ++t)
+			{
+				std::copy(part(t).begin(), part(t).end(), out.begin() + offsets[t]);
+				part(t).clear();
+			}
+		});
+	};
+
+	auto gatherBucket = [&](std::vector<uint32_t>& out) {
+		gather(out, [&](size_t t) -> std::vector<uint32_t>& { return bins[t][bucket % binCount]; });
+		occupied[bucket % binCount].store(0, std::memory_order_relaxed);
+	};
+
+	distances[source].store(0, std::memory_order_relaxed);
+	std::vector<uint32_t> frontier = { (uint32_t)source };
+	std::vector<uint32_t> bucketSettled;
+	std::vector<uint32_t> far;
+
+	while (true)
+	{
+		while (!frontier.empty())
+		{
+			pool.parallelFor(frontier.size(), GRAIN, [&](size_t begin, size_t end, size_t thread) {
+				for (size_t f = begin; f < end; ++f)
+				{
+					uint32_t u = frontier[f];
+					size_t dist = distances[u].load(std::memory_order_relaxed);
+
+					// Entries left behind after u moved to a lower bucket
+					if (dist / delta != bucket)
+						continue;
+
+					settled[thread].push_back(u);
+					for (size_t i = g.edgesBegin(u); i < g.edgesEnd(u); ++i)
+					{
+						if ((size_t)g.weight(i) <= delta)
+							relax(g.target(i), dist + g.weight(i), thread);
+					}
+				}
+			});
+
+			gatherBucket(frontier);
+		}
+
+		gather(bucketSettled, [&](size_t t) -> std::vector<uint32_t>& { return settled[t]; });
+		pool.parallelFor(bucketSettled.size(), GRAIN, [&](size_t begin, size_t end, size_t thread) {
+			for (size_t f = begin; f < end; ++f)
+			{
+				uint32_t u = bucketSettled[f];
+				size_t dist = distances[u].load(std::memory_order_relaxed);
+				for (size_t i = g.edgesBegin(u); i < g.edgesEnd(u); ++i)
+				{
+					if ((size_t)g.weight(i) > delta)
+						relax(g.target(i), dist + g.weight(i), thread);
+				}
+			}
+		});
+
+		// The next bucket is the nearest occupied bin, unless the overflow
+		// list holds a nearer one
+		size_t farFirst = *std::min_element(overflowFirst.begin(), overflowFirst.end());
+		size_t next = 1;
+		while (next < binCount && bucket + next < farFirst && !occupied[(bucket + next) % binCount].load(std::memory_order_relaxed))
+			++next;
+
+		if (bucket + next < farFirst && next < binCount)
+		{
+			bucket += next;
+		}
+		else if (farFirst != SIZE_MAX)
+		{
+			// Every bin before farFirst is empty. Overflow entries whose
+			// vertex has since been filed nearer are stale; the others are
+			// filed again relative to the new bucket.
+			bucket = farFirst;
+			gather(far, [&](size_t t) -> std::vector<uint32_t>& { return overflow[t]; });
+			std::fill(overflowFirst.begin(), overflowFirst.end(), SIZE_MAX);
+			for (uint32_t v : far)
+			{
+				size_t target = distances[v].load(std::memory_order_relaxed) / delta;
+				if (target >= bucket)
+					file(v, target, 0);
+			}
+		}
+		else
+		{
+			break;
+		}
+
+		gatherBucket(frontier);
+	}
+
+	std::vector<size_t> result(V);
+	pool.parallelFor(V, 1024, [&](size_t begin, size_t end, size_t) {
+		for (size_t v = begin; v < end; ++v)
+			result[v] = distances[v].load(std::memory_order_relaxed);
+	});
+
+	return result;
+}
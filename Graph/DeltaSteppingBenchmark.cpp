@@ -0,0 +1,54 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "CsrGraph.h"
+#include "DeltaStepping.h"
+#include "RmatGraph.h"
+#include "Benchmark.h"
+
+// deltaStepping on an undirected R-MAT graph of 2^scale vertices, 16 * 2^scale
+// edges and weights in [1, MAX_WEIGHT] (scale 18 unless given on the command
+// line), swept over delta and over pools of 1, 2, 4, ... threads up to every
+// core. delta 0 is the automatic choice. Every run must return the distances
+// of the first one, which is delta 1 on one thread, where every bucket holds
+// a single distance as in Dial's algorithm.
+
+const size_t EDGE_FACTOR = 16;
+const int MAX_WEIGHT = 1000;
+
+int main(int argc, char* argv[])
+{
+	size_t scale = argc > 1 ? std::stoul(argv[1]) : 18;
+	CsrGraph g((size_t)1 << scale, rmatEdges(scale, EDGE_FACTOR, MAX_WEIGHT, 1), false);
+
+	// Start from the highest degree vertex, which is in the giant component
+	size_t source = 0;
+	for (size_t v = 0; v < g.vertexCount(); ++v)
+	{
+		if (g.edgesEnd(v) - g.edgesBegin(v) > g.edgesEnd(source) - g.edgesBegin(source))
+			source = v;
+	}
+
+	std::cout << g.vertexCount() << " vertices, " << g.edgeCount() << " adjacency entries" << std::endl;
+	std::cout << "delta";
+	for (size_t threads : threadCounts())
+		std::cout << "\t" << threads << " thr ms";
+	std::cout << std::endl;
+
+	std::vector<size_t> expected;
+	for (size_t delta : { 1, 0, 8, 32, 128, 512, 2048 })
+	{
+		std::cout << (delta == 0 ? std::string("auto") : std::to_string(delta));
+		for (size_t threads : threadCounts())
+		{
+			ThreadPool pool(threads);
+			std::vector<size_t> distances;
+			double time = timeSeconds([&] { distances = deltaStepping(g, source, pool, delta); });
+
+			if (expected.empty())
+				expected = distances;
+			std::cout << "\t" << time * 1e3 << (distances == expected ? "" : " MISMATCH");
+		}
+		std::cout << std::endl;
+	}
+}
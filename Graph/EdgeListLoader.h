@@ -0,0 +1,325 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define EDGE_LIST_MMAP
+#endif
+
+namespace EdgeListDetail
+{
+	// Read-only view of a whole file: mapped into memory where mmap exists,
+	// read into a buffer otherwise
+	class FileView
+	{
+	public:
+
+		explicit FileView(const std::string& path);
+		FileView(const FileView& other) = delete;
+		FileView& operator=(const FileView& other) = delete;
+		~FileView();
+
+		const char* data() const { return begin; }
+		size_t size() const { return length; }
+
+	private:
+
+		const char* begin = nullptr;
+		size_t length = 0;
+		bool mapped = false;
+		std::vector<char> buffer;
+	};
+
+	inline FileView::FileView(const std::string& path)
+	{
+#ifdef EDGE_LIST_MMAP
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("Cannot open " + path);
+
+		struct stat info = {};
+		if (fstat(fd, &info) == 0 && info.st_size > 0)
+		{
+			void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (address != MAP_FAILED)
+			{
+				madvise(address, (size_t)info.st_size, MADV_SEQUENTIAL);
+				begin = (const char*)address;
+				length = (size_t)info.st_size;
+				mapped = true;
+			}
+		}
+		close(fd);
+
+		if (mapped || info.st_size == 0)
+			return;
+#endif
+		std::ifstream in(path, std::ios::binary);
+		if (!in)
+			throw std::runtime_error("Cannot open " + path);
+
+		buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+		begin = buffer.data();
+		length = buffer.size();
+	}
+
+	inline FileView::~FileView()
+	{
+#ifdef EDGE_LIST_MMAP
+		if (mapped)
+			munmap((void*)begin, length);
+#endif
+	}
+
+	struct ParsedEdge
+	{
+		uint32_t start;
+		uint32_t end;
+		int weight;
+	};
+
+	inline bool isBlank(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// Reads an optionally signed decimal integer. Numbers longer than anything
+	// a vertex id or an int weight can hold are rejected before they overflow.
+	inline const char* parseInteger(const char* p, const char* end, int64_t& value, const char* fileBegin)
+	{
+		const size_t MAX_DIGITS = 12;
+
+		bool negative = p != end && *p == '-';
+		if (negative)
+			++p;
+
+		const char* digits = p;
+		uint64_t result = 0;
+		for (; p != end; ++p)
+		{
+			unsigned digit = (unsigned char)*p - '0';
+			if (digit > 9)
+				break;
+			result = result * 10 + digit;
+		}
+
+		if (p == digits || (size_t)(p - digits) > MAX_DIGITS)
+			throw std::runtime_error("Malformed edge list at byte " + std::to_string(digits - fileBegin));
+
+		value = negative ? -(int64_t)result : (int64_t)result;
+		return p;
+	}
+
+	// Parses the lines in [p, end), which starts at a line boundary
+	inline void parseChunk(const char* p, const char* end, const char* fileBegin,
+		std::vector<ParsedEdge>& edges, uint32_t& maxVertex)
+	{
+		while (p != end)
+		{
+			while (p != end && isBlank(*p))
+				++p;
+
+			// Blank and comment lines
+			if (p == end || *p == '\n' || *p == '#' || *p == '%')
+			{
+				const char* newline = (const char*)memchr(p, '\n', end - p);
+				p = newline ? newline + 1 : end;
+				continue;
+			}
+
+			int64_t numbers[3] = { 0, 0, 1 };
+			size_t count = 0;
+			while (p != end && *p != '\n')
+			{
+				if (count == 3)
+					throw std::runtime_error("Malformed edge list at byte " + std::to_string(p - fileBegin));
+				p = parseInteger(p, end, numbers[count++], fileBegin);
+				while (p != end && isBlank(*p))
+					++p;
+			}
+			if (p != end)
+				++p;
+
+			if (count < 2 || numbers[0] < 0 || numbers[1] < 0 || numbers[0] >= UINT32_MAX || numbers[1] >= UINT32_MAX
+				|| numbers[2] < INT_MIN || numbers[2] > INT_MAX)
+				throw std::runtime_error("Invalid edge before byte " + std::to_string(p - fileBegin));
+
+			edges.push_back({ (uint32_t)numbers[0], (uint32_t)numbers[1], (int)numbers[2] });
+			maxVertex = std::max(maxVertex, (uint32_t)std::max(numbers[0], numbers[1]));
+		}
+	}
+}
+
+// Loads a text edge list with one "start end [weight]" line per edge into a
+// CsrGraph; a missing weight is 1, lines starting with # or % are comments,
+// and the vertex count is the largest id plus one.
+//
+// The file is mapped instead of read (on POSIX systems; elsewhere it is read
+// into one buffer), cut into chunks at line boundaries, and every chunk is
+// parsed on its own thread. The adjacency is then built with a
+// two-level counting sort, both levels stable: the parsed edges are scattered
+// into ranges of vertex ids, each thread counting its chunk's share of every
+// range first so the writes need no synchronization, and then every range is
+// sorted by start vertex on its own. Neighbor lists come out in file order,
+// exactly as CsrGraph(vertexCount, edges, isOriented) would build them.
+inline CsrGraph loadEdgeList(const std::string& path, bool isOriented, ThreadPool& pool)
+{
+	using namespace EdgeListDetail;
+
+	const size_t MIN_CHUNK_BYTES = 1 << 20;
+	const size_t CHUNKS_PER_THREAD = 4;
+	const size_t BYTES_PER_LINE_GUESS = 16;
+	const size_t RANGES_PER_THREAD = 16;
+	const size_t ENTRIES_PER_RANGE = 1 << 15;
+
+	FileView file(path);
+	const char* text = file.data();
+	size_t threads = pool.size();
+
+	size_t chunkCount = std::max<size_t>(1, std::min(file.size() / MIN_CHUNK_BYTES, threads * CHUNKS_PER_THREAD));
+	std::vector<size_t> chunkStarts(chunkCount + 1, file.size());
+	chunkStarts[0] = 0;
+	for (size_t c = 1; c < chunkCount; ++c)
+	{
+		size_t position = std::max(chunkStarts[c - 1], file.size() / chunkCount * c);
+		const char* newline = (const char*)memchr(text + position, '\n', file.size() - position);
+		chunkStarts[c] = newline ? newline - text + 1 : file.size();
+	}
+
+	// Errors are kept per chunk, so the one reported is the first in the file
+	// rather than whichever thread happened to fail first
+	std::vector<std::vector<ParsedEdge>> chunkEdges(chunkCount);
+	std::vector<uint32_t> chunkMaxVertex(chunkCount, 0);
+	std::vector<std::exception_ptr> chunkErrors(chunkCount);
+	pool.parallelFor(chunkCount, 1, [&](size_t begin, size_t end, size_t) {
+		for (size_t c = begin; c < end; ++c)
+		{
+			try
+			{
+				chunkEdges[c].reserve((chunkStarts[c + 1] - chunkStarts[c]) / BYTES_PER_LINE_GUESS);
+				parseChunk(text + chunkStarts[c], text + chunkStarts[c + 1], text, chunkEdges[c], chunkMaxVertex[c]);
+			}
+			catch (...)
+			{
+				chunkErrors[c] = std::current_exception();
+			}
+		}
+	});
+
+	for (const std::exception_ptr& error : chunkErrors)
+	{
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	bool empty = std::all_of(chunkEdges.begin(), chunkEdges.end(), [](const std::vector<ParsedEdge>& edges) {
+		return edges.empty();
+		});
+	size_t V = empty ? 0 : (size_t)*std::max_element(chunkMaxVertex.begin(), chunkMaxVertex.end()) + 1;
+
+	size_t entryCount = 0;
+	for (const std::vector<ParsedEdge>& edges : chunkEdges)
+		entryCount += isOriented ? edges.size() : 2 * edges.size();
+
+	// First level: ranges of 2^shift vertex ids, enough of them to keep every
+	// thread busy and small enough that the second level's scattered writes
+	// into a range's slice of the output stay in cache
+	size_t wantedRanges = std::max(threads * RANGES_PER_THREAD, entryCount / ENTRIES_PER_RANGE);
+	size_t shift = 0;
+	while ((V >> shift) > wantedRanges)
+		++shift;
+	size_t rangeCount = (V >> shift) + 1;
+
+	std::vector<size_t> positions(chunkCount * rangeCount, 0);
+	pool.parallelFor(chunkCount, 1, [&](size_t begin, size_t end, size_t) {
+		for (size_t c = begin; c < end; ++c)
+		{
+			size_t* counts = &positions[c * rangeCount];
+			for (const ParsedEdge& e : chunkEdges[c])
+			{
+				counts[e.start >> shift]++;
+				if (!isOriented)
+					counts[e.end >> shift]++;
+			}
+		}
+	});
+
+	// Range-major, chunk-minor, so every range keeps the file order
+	std::vector<size_t> rangeStarts(rangeCount + 1, 0);
+	size_t total = 0;
+	for (size_t r = 0; r < rangeCount; ++r)
+	{
+		rangeStarts[r] = total;
+		for (size_t c = 0; c < chunkCount; ++c)
+		{
+			size_t count = positions[c * rangeCount + r];
+			positions[c * rangeCount + r] = total;
+			total += count;
+		}
+	}
+	rangeStarts[rangeCount] = total;
+
+	std::vector<ParsedEdge> entries(total);
+	pool.parallelFor(chunkCount, 1, [&](size_t begin, size_t end, size_t) {
+		for (size_t c = begin; c < end; ++c)
+		{
+			size_t* next = &positions[c * rangeCount];
+			for (const ParsedEdge& e : chunkEdges[c])
+			{
+				entries[next[e.start >> shift]++] = e;
+				if (!isOriented)
+					entries[next[e.end >> shift]++] = { e.end, e.start, e.weight };
+			}
+			std::vector<ParsedEdge>().swap(chunkEdges[c]);
+		}
+	});
+
+	// Second level: every range owns offsets[first + 1 .. last] and its slice
+	// of the target and weight arrays
+	std::vector<size_t> offsets(V + 1, 0);
+	std::vector<uint32_t> targets(total);
+	std::vector<int> weights(total);
+	pool.parallelFor(rangeCount, 1, [&](size_t begin, size_t end, size_t) {
+		std::vector<size_t> next;
+		for (size_t r = begin; r < end; ++r)
+		{
+			size_t first = std::min(V, r << shift);
+			size_t last = std::min(V, (r + 1) << shift);
+
+			next.assign(last - first, 0);
+			for (size_t i = rangeStarts[r]; i < rangeStarts[r + 1]; ++i)
+				next[entries[i].start - first]++;
+
+			size_t position = rangeStarts[r];
+			for (size_t v = first; v < last; ++v)
+			{
+				size_t degree = next[v - first];
+				next[v - first] = position;
+				position += degree;
+				offsets[v + 1] = position;
+			}
+
+			for (size_t i = rangeStarts[r]; i < rangeStarts[r + 1]; ++i)
+			{
+				size_t slot = next[entries[i].start - first]++;
+				targets[slot] = entries[i].end;
+				weights[slot] = entries[i].weight;
+			}
+		}
+	});
+
+	return CsrGraph(std::move(offsets), std::move(targets), std::move(weights), isOriented);
+}
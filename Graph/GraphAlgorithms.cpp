@@ -3,66 +3,12 @@
 #include <queue>
 #include <tuple>
 #include <algorithm>
-
-struct MST
-{
-	std::vector<std::tuple<size_t, size_t, int>> edges;
-	size_t sumOfWeights;
-};
-
-class UnionFind
-{
-public:
-
-	UnionFind(int n) : parent(n), height(n, 0)
-	{
-		for (int i = 0; i < n; ++i)
-			parent[i] = i;
-	}
-
-	int getRoot(int n)
-	{
-		if (parent[n] != n)
-			parent[n] = getRoot(parent[n]);
-		return parent[n];
-	}
-	bool areInOneSet(int n, int k)
-	{
-		return getRoot(n) == getRoot(k);
-	}
-	bool Union(int n, int k)
-	{
-		int root1 = getRoot(n);
-		int root2 = getRoot(k);
-
-		if (root1 == root2)
-		{
-			return false;
-		}
-		if (height[root1] < height[root2])
-		{
-			parent[root1] = root2;
-		}
-		else if (height[root1] > height[root2])
-		{
-			parent[root2] = root1;
-		}
-		else
-		{
-			parent[root2] = root1;
-			height[root1]++;
-		}
-
-		return true;
-	}
-
-private:
-
-	std::vector<int> parent;
-	std::vector<int> height;
-};
-
-using Edge = std::tuple<size_t, size_t, int>;
+#include <climits>
+#include <cstdint>
+#include "GraphTypes.h"
+#include "CsrGraph.h"
+#include "../Disjoint Set/UnionByHeight/UnionFind.h"
+#include "../PriorityQueue/IndexedPriorityQueue.h"
 
 class Graph
 {
@@ -77,6 +23,23 @@ public:
 			adj[end].push_back({ start, weight });
 	}
 
+	// Flat copy of the graph for the algorithms in CsrGraph.h.
+	// Self-loops of undirected graphs are dropped.
+	CsrGraph toCsr() const
+	{
+		std::vector<Edge> edges;
+		for (size_t i = 0; i < V; ++i)
+		{
+			for (auto& p : adj[i])
+			{
+				if (oriented || i < (size_t)p.first)
+					edges.push_back({ i, (size_t)p.first, p.second });
+			}
+		}
+
+		return CsrGraph(V, edges, oriented);
+	}
+
 	size_t dijstra(size_t start, size_t end, std::vector<size_t>& path) const
 	{
 		struct VertexDistance
@@ -132,97 +95,251 @@ public:
 		return INT_MAX;
 	}
 
+	// Grows the tree from vertex 0. Each vertex outside the tree keeps only its
+	// cheapest edge into the tree as its key, so the queue holds at most V
+	// entries and a cheaper edge lowers a key in place instead of adding a
+	// stale entry. On dense graphs a heap only adds overhead: one O(V) scan per
+	// step over the key array gives O(V^2) in total, which is already the size
+	// of the input.
 	MST Prim() const
 	{
-		struct primEdge
-		{
-			size_t start;
-			size_t end;
-			int weight;
+		size_t adjacencyEntries = 0;
+		for (size_t i = 0; i < V; ++i)
+			adjacencyEntries += adj[i].size();
+
+		if (adjacencyEntries * PRIM_DENSE_FACTOR >= V * V)
+			return primDense();
+		return primIndexedHeap();
+	}
+
+	// Filter-Kruskal: instead of sorting every edge up front, split the edges
+	// around a pivot weight, build the forest from the light part first and then
+	// throw away the heavy edges that already close a cycle before looking at
+	// them any further. On large graphs most heavy edges are filtered out and
+	// never sorted. Undirected edges are taken once, not once per direction.
+	MST Kruskal() const
+	{
+		MST result;
+		result.sumOfWeights = 0;
+		if (V == 0)
+			return result;
 
-			bool operator<(const primEdge& other) const
+		std::vector<KruskalEdge> edges;
+		for (size_t i = 0; i < V; ++i)
+		{
+			for (auto& p : adj[i])
 			{
-				return weight > other.weight;
+				if (oriented || i < (size_t)p.first)
+					edges.push_back({ (uint32_t)i, (uint32_t)p.first, p.second });
 			}
-		};
+		}
 
+		UnionFind uf(V);
+		std::vector<KruskalEdge> buffer;
+		uint32_t seed = 0x9E3779B9;
+		filterKruskal(edges, 0, edges.size(), uf, buffer, seed, result);
+
+		return result;
+	}
+
+private:
+
+	bool oriented;
+	size_t V;
+	std::vector<std::vector<std::pair<int, int>>> adj;
+
+	// Prim scans an array instead of using a heap once the adjacency lists
+	// hold at least V^2 / PRIM_DENSE_FACTOR entries, about where the two cross
+	static const size_t PRIM_DENSE_FACTOR = 2;
+
+	MST primIndexedHeap() const
+	{
 		MST result;
 		result.sumOfWeights = 0;
-		std::priority_queue<primEdge> q;
-		std::vector<bool> visited(V);
-		q.push({0, 0, 0});
-		size_t addedEdges = 0;
-		bool isFirst = true;
+		if (V == 0)
+			return result;
+
+		IndexedPriorityQueue<int> q(V);
+		std::vector<size_t> parent(V);
+		std::vector<bool> inTree(V);
+		q.insert(0, 0);
 
-		while (addedEdges < V && !q.empty())
+		while (!q.empty())
 		{
-			auto current = q.top();
+			size_t current = q.peekIndex();
+			int weight = q.peekKey();
 			q.pop();
+			inTree[current] = true;
 
-			if (visited[current.end])
+			if (current != 0)
 			{
-				continue;
+				result.edges.push_back({ parent[current], current, weight });
+				result.sumOfWeights += weight;
 			}
 
-			visited[current.end] = true;
-			for (int i = 0; i < adj[current.end].size(); ++i)
-			{
-				q.push({ current.end, (size_t)adj[current.end][i].first, adj[current.end][i].second });
-			}
-			
-			if (isFirst)
+			for (auto& p : adj[current])
 			{
-				isFirst = false;
-				continue;
-			}
+				size_t next = p.first;
+				if (inTree[next])
+					continue;
 
-			result.edges.push_back({ current.start, current.end, current.weight });
-			result.sumOfWeights += current.weight;
-			addedEdges++;
+				if (!q.contains(next))
+				{
+					q.insert(next, p.second);
+					parent[next] = current;
+				}
+				else if (p.second < q.keyOf(next))
+				{
+					q.decreaseKey(next, p.second);
+					parent[next] = current;
+				}
+			}
 		}
 
 		return result;
 	}
 
-	MST Kruskal() const
+	// The whole state is one key per vertex, so finding the next vertex is a
+	// branch-free minimum over a flat array. Keys are 64 bits wide so that the
+	// two markers stay above every int weight.
+	MST primDense() const
 	{
+		const long long IN_TREE = LLONG_MAX;
+		const long long NOT_REACHED = LLONG_MAX - 1;
+
 		MST result;
 		result.sumOfWeights = 0;
-		std::vector<Edge> edges;
+		if (V == 0)
+			return result;
 
-		for (int i = 0; i < V; ++i)
+		std::vector<long long> key(V, NOT_REACHED);
+		std::vector<size_t> parent(V, 0);
+		key[0] = 0;
+
+		for (size_t step = 0; step < V; ++step)
 		{
-			for (auto& p : adj[i])
+			size_t current = 0;
+			for (size_t v = 1; v < V; ++v)
+				current = key[v] < key[current] ? v : current;
+
+			// The rest of the graph is not connected to vertex 0
+			if (key[current] >= NOT_REACHED)
+				break;
+
+			if (step != 0)
 			{
-				edges.push_back({ i, (size_t)p.first, p.second });
+				result.edges.push_back({ parent[current], current, (int)key[current] });
+				result.sumOfWeights += (int)key[current];
+			}
+			key[current] = IN_TREE;
+
+			for (auto& p : adj[current])
+			{
+				size_t next = p.first;
+				if (p.second < key[next] && key[next] != IN_TREE)
+				{
+					key[next] = p.second;
+					parent[next] = current;
+				}
 			}
 		}
 
-		std::sort(edges.begin(), edges.end(), [](const Edge& lhs, const Edge& rhs) {
-			return std::get<2>(lhs) < std::get<2>(rhs);
-			});
+		return result;
+	}
 
-		UnionFind uf(V);
-		size_t edgesIncluded = 0;
+	struct KruskalEdge
+	{
+		uint32_t start;
+		uint32_t end;
+		int weight;
+	};
 
-		for (int i = 0; i < edges.size() && edgesIncluded < V - 1; ++i)
+	// Ranges at most this long are sorted and scanned directly
+	static const size_t FILTER_KRUSKAL_CUTOFF = 1 << 12;
+
+	void filterKruskal(std::vector<KruskalEdge>& edges, size_t begin, size_t end, UnionFind& uf,
+		std::vector<KruskalEdge>& buffer, uint32_t& seed, MST& result) const
+	{
+		if (result.edges.size() == V - 1 || begin == end)
+			return;
+
+		if (end - begin <= FILTER_KRUSKAL_CUTOFF)
+		{
+			sortByWeight(edges, begin, end, buffer);
+			addEdges(edges, begin, end, uf, result);
+			return;
+		}
+
+		// Median of three random weights
+		int sample[3];
+		for (int& w : sample)
+		{
+			seed = seed * 1664525 + 1013904223;
+			w = edges[begin + seed % (end - begin)].weight;
+		}
+		std::sort(sample, sample + 3);
+		int pivot = sample[1];
+
+		// [begin, light) < pivot, [light, heavy) == pivot, [heavy, end) > pivot.
+		// Edges equal to the pivot need no sorting, and keeping them apart also
+		// ends the recursion when all weights are the same.
+		auto first = edges.begin();
+		size_t light = std::partition(first + begin, first + end, [pivot](const KruskalEdge& e) { return e.weight < pivot; }) - first;
+		size_t heavy = std::partition(first + light, first + end, [pivot](const KruskalEdge& e) { return e.weight == pivot; }) - first;
+
+		filterKruskal(edges, begin, light, uf, buffer, seed, result);
+		addEdges(edges, light, heavy, uf, result);
+		if (result.edges.size() == V - 1)
+			return;
+
+		size_t kept = std::partition(first + heavy, first + end, [&uf](const KruskalEdge& e) {
+			return uf.getRoot(e.start) != uf.getRoot(e.end);
+			}) - first;
+		filterKruskal(edges, heavy, kept, uf, buffer, seed, result);
+	}
+
+	void addEdges(const std::vector<KruskalEdge>& edges, size_t begin, size_t end, UnionFind& uf, MST& result) const
+	{
+		for (size_t i = begin; i < end && result.edges.size() < V - 1; ++i)
 		{
-			auto& e = edges[i];
-			if (uf.Union(std::get<0>(e), std::get<1>(e)))
+			const KruskalEdge& e = edges[i];
+			if (uf.Union(e.start, e.end))
 			{
-				result.edges.push_back(e);
-				result.sumOfWeights += std::get<2>(e);
-				edgesIncluded++;
+				result.edges.push_back({ e.start, e.end, e.weight });
+				result.sumOfWeights += e.weight;
 			}
 		}
-
-		return result;
 	}
 
-private:
+	// LSD radix sort on the weight, one byte per pass. The sign bit is flipped
+	// so that negative weights order first, and passes where every key has the
+	// same byte are skipped, which for small weights leaves one or two passes.
+	static void sortByWeight(std::vector<KruskalEdge>& edges, size_t begin, size_t end, std::vector<KruskalEdge>& buffer)
+	{
+		size_t n = end - begin;
+		buffer.resize(std::max(buffer.size(), n));
+		KruskalEdge* from = edges.data() + begin;
+		KruskalEdge* to = buffer.data();
 
-	bool oriented;
-	size_t V;
-	std::vector<std::vector<std::pair<int, int>>> adj;
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			size_t counts[257] = {};
+			for (size_t i = 0; i < n; ++i)
+				counts[((((uint32_t)from[i].weight) ^ 0x80000000u) >> shift & 0xFF) + 1]++;
+
+			if (counts[((((uint32_t)from[0].weight) ^ 0x80000000u) >> shift & 0xFF) + 1] == n)
+				continue;
+
+			for (size_t b = 0; b < 256; ++b)
+				counts[b + 1] += counts[b];
+			for (size_t i = 0; i < n; ++i)
+				to[counts[(((uint32_t)from[i].weight) ^ 0x80000000u) >> shift & 0xFF]++] = from[i];
+
+			std::swap(from, to);
+		}
+
+		if (from != edges.data() + begin)
+			std::copy(from, from + n, edges.data() + begin);
+	}
 
 };
@@ -1,7 +1,48 @@
 #include <iostream>
 #include <vector>
+#include <string>
+#include <random>
 #include <queue>
 #include <stack>
+#include <algorithm>
+#include <functional>
+#include <climits>
+#include <cstdint>
+#include "TraversalWorkspace.h"
+#include "Benchmark.h"
+
+// Heuristic that makes astar behave exactly like dijkstra
+struct ZeroHeuristic
+{
+	size_t operator()(size_t, size_t) const
+	{
+		return 0;
+	}
+};
+
+// ALT heuristic (A*, landmarks, triangle inequality). For every landmark L,
+// d(L, end) <= d(L, v) + d(v, end) and d(v, L) <= d(v, end) + d(end, L), so
+// d(L, end) - d(L, v) and d(v, L) - d(end, L) are both lower bounds on
+// d(v, end). Built by Graph::landmarks.
+class LandmarkHeuristic
+{
+public:
+
+	size_t operator()(size_t vertex, size_t end) const;
+
+	const std::vector<size_t>& getLandmarks() const;
+
+private:
+
+	friend class Graph;
+
+	// Distances stored vertex by vertex, landmarkCount entries each, so one
+	// evaluation reads two short contiguous runs
+	std::vector<size_t> landmarkIds;
+	std::vector<size_t> fromLandmark;
+	std::vector<size_t> toLandmark; // oriented graphs only, d(v, L) == d(L, v) otherwise
+	size_t landmarkCount = 0;
+};
 
 class Graph
 {
@@ -11,81 +52,669 @@ public:
 
 	void addEdge(size_t start, size_t end, int weight);
 	size_t dijkstra(size_t start, size_t end, std::vector<size_t>& path) const;
+	size_t dijkstra(size_t start, size_t end, std::vector<size_t>& path, TraversalWorkspace& workspace) const;
+	// distances[i] = distance from start to targets[i]; stops once every target is settled
+	void dijkstra_targets(size_t start, const size_t* targets, size_t count, size_t* distances, TraversalWorkspace& workspace) const;
+	// Distances and predecessors from source to every vertex
+	ShortestPathTree shortest_distances(size_t source) const;
+	// Distances to the nearest of the sources; following parents from v ends at that source
+	ShortestPathTree shortest_distances_multi_source(const std::vector<size_t>& sources) const;
+	size_t dijkstra_bidirectional(size_t start, size_t end, std::vector<size_t>& path) const;
+	size_t dijkstra_bidirectional(size_t start, size_t end, std::vector<size_t>& path,
+		TraversalWorkspace& forward, TraversalWorkspace& backward) const;
+
+	// heuristic(v, end) must never overestimate the distance from v to end
+	template<typename Heuristic>
+	size_t astar(size_t start, size_t end, Heuristic heuristic, std::vector<size_t>& path) const;
+	template<typename Heuristic>
+	size_t astar(size_t start, size_t end, Heuristic heuristic, std::vector<size_t>& path, TraversalWorkspace& workspace) const;
+
+	LandmarkHeuristic landmarks(size_t count) const;
 
 private:
 
 	std::vector<std::vector<std::pair<int, int>>> adj;
+	std::vector<std::vector<std::pair<int, int>>> radj; // incoming edges, oriented graphs only
 	size_t V;
 	bool oriented;
+
+	// Largest weight Dial's algorithm is used for; it scans maxWeight + 1 buckets in a circle
+	static const int DIAL_MAX_WEIGHT = 1024;
+	int maxWeight = 0;
+	bool hasNegativeWeights = false;
+
+	size_t dijkstra_binary_heap(size_t start, size_t end, std::vector<size_t>& path, TraversalWorkspace& workspace) const;
+	size_t dijkstra_dial(size_t start, size_t end, std::vector<size_t>& path, TraversalWorkspace& workspace) const;
+	size_t dijkstra_radix_heap(size_t start, size_t end, std::vector<size_t>& path, TraversalWorkspace& workspace) const;
+	static void reconstruct_path(size_t start, size_t end, std::vector<size_t>& path, const TraversalWorkspace& workspace);
+
+	// Relaxes the edges leaving vertex, whose distance is dist: every neighbor
+	// that gets closer is labelled with vertex as its parent and handed to
+	// push(newDist, neighbor), which queues it in the search's own structure
+	template<typename Push>
+	static void relax(const std::vector<std::pair<int, int>>& edges, size_t vertex, size_t dist, TraversalWorkspace& workspace, Push push);
+
+	ShortestPathTree shortest_paths_tree(const std::vector<size_t>& sources, const std::vector<std::vector<std::pair<int, int>>>& edges) const;
 };
 
-Graph::Graph(size_t vertexCount, bool isOriented) : adj(vertexCount), V(vertexCount), oriented(isOriented) {}
+Graph::Graph(size_t vertexCount, bool isOriented) : adj(vertexCount), radj(isOriented ? vertexCount : 0), V(vertexCount), oriented(isOriented) {}
 
 void Graph::addEdge(size_t start, size_t end, int weight)
 {
+	maxWeight = std::max(maxWeight, weight);
+	hasNegativeWeights = hasNegativeWeights || weight < 0;
+
 	adj[start].push_back({ end, weight });
 	if (!oriented)
 		adj[end].push_back({ start, weight });
+	else
+		radj[end].push_back({ start, weight });
 }
 
 size_t Graph::dijkstra(size_t start, size_t end, std::vector<size_t>& path) const
 {
-	struct vertexAndDistancePair
+	TraversalWorkspace workspace(V);
+	return dijkstra(start, end, path, workspace);
+}
+
+// Integer weights allow a priority queue without comparisons: Dial's
+// circular buckets when the weights are small, a radix heap otherwise.
+// Negative weights keep the binary heap, which at least stays well defined.
+size_t Graph::dijkstra(size_t start, size_t end, std::vector<size_t>& path, TraversalWorkspace& workspace) const
+{
+	if (hasNegativeWeights)
+		return dijkstra_binary_heap(start, end, path, workspace);
+	if (maxWeight <= DIAL_MAX_WEIGHT)
+		return dijkstra_dial(start, end, path, workspace);
+	return dijkstra_radix_heap(start, end, path, workspace);
+}
+
+void Graph::reconstruct_path(size_t start, size_t end, std::vector<size_t>& path, const TraversalWorkspace& workspace)
+{
+	while (end != start)
 	{
-		size_t vertex;
-		size_t distFromStart;
+		path.push_back(end);
+		end = workspace.parent(end);
+	}
 
-		bool operator<(const vertexAndDistancePair& other) const
+	path.push_back(start);
+	std::reverse(path.begin(), path.end());
+}
+
+template<typename Push>
+void Graph::relax(const std::vector<std::pair<int, int>>& edges, size_t vertex, size_t dist, TraversalWorkspace& workspace, Push push)
+{
+	for (const auto& edge : edges)
+	{
+		size_t newDist = dist + edge.second;
+		if (newDist < workspace.distance(edge.first))
 		{
-			return distFromStart > other.distFromStart;
+			workspace.setDistance(edge.first, newDist, vertex);
+			push(newDist, (size_t)edge.first);
 		}
-	};
+	}
+}
 
-	std::vector<size_t> distances(V, INT_MAX);
-	std::vector<size_t> prevs(V);
-	std::priority_queue<vertexAndDistancePair> q;
+// The workspace supplies the distances, predecessors and heap storage, so
+// repeated queries neither allocate nor clear anything proportional to V.
+size_t Graph::dijkstra_binary_heap(size_t start, size_t end, std::vector<size_t>& path, TraversalWorkspace& workspace) const
+{
+	// (distance from start, vertex), smallest distance on top
+	using vertexAndDistancePair = std::pair<size_t, size_t>;
+	std::greater<vertexAndDistancePair> later;
+
+	workspace.reset(V);
+	std::vector<vertexAndDistancePair>& q = workspace.heap();
 
-	distances[start] = 0;
-	q.push({ start, 0 });
+	workspace.setDistance(start, 0, start);
+	q.push_back({ 0, start });
 
 	while (!q.empty())
 	{
-		vertexAndDistancePair current = q.top();
-		q.pop();
+		std::pop_heap(q.begin(), q.end(), later);
+		vertexAndDistancePair current = q.back();
+		q.pop_back();
+
+		size_t currentVertex = current.second;
+		if (current.first > workspace.distance(currentVertex))
+			continue;
+
+		if (currentVertex == end)
+		{
+			reconstruct_path(start, end, path, workspace);
+			return current.first;
+		}
+
+		relax(adj[currentVertex], currentVertex, current.first, workspace, [&](size_t newDist, size_t neighbor) {
+			q.push_back({ newDist, neighbor });
+			std::push_heap(q.begin(), q.end(), later);
+		});
+	}
+
+	return INT_MAX;
+}
+
+// Dial's algorithm. Every tentative distance lies in [current, current + maxWeight],
+// so maxWeight + 1 buckets indexed by distance modulo their count hold each
+// distance in its own bucket, and the next vertex to settle is found by
+// walking forward from the current bucket. Push and pop are O(1) and the walk
+// adds O(distance to end) in total.
+size_t Graph::dijkstra_dial(size_t start, size_t end, std::vector<size_t>& path, TraversalWorkspace& workspace) const
+{
+	size_t bucketCount = (size_t)maxWeight + 1;
+
+	workspace.reset(V);
+	std::vector<std::vector<std::pair<size_t, size_t>>>& buckets = workspace.buckets(bucketCount);
 
-		if (current.vertex == end)
+	workspace.setDistance(start, 0, start);
+	buckets[0].push_back({ 0, start });
+	size_t pending = 1;
+
+	for (size_t currentDist = 0; pending > 0; ++currentDist)
+	{
+		std::vector<std::pair<size_t, size_t>>& bucket = buckets[currentDist % bucketCount];
+
+		// Zero weight edges append to the bucket being scanned
+		while (!bucket.empty())
 		{
-			while (end != start)
+			size_t currentVertex = bucket.back().second;
+			bool isStale = bucket.back().first != workspace.distance(currentVertex);
+			bucket.pop_back();
+			--pending;
+
+			if (isStale)
+				continue;
+
+			if (currentVertex == end)
 			{
-				path.push_back(end);
-				end = prevs[end];
+				reconstruct_path(start, end, path, workspace);
+				return currentDist;
 			}
 
-			path.push_back(start);
-			std::reverse(path.begin(), path.end());
+			relax(adj[currentVertex], currentVertex, currentDist, workspace, [&](size_t newDist, size_t neighbor) {
+				buckets[newDist % bucketCount].push_back({ newDist, neighbor });
+				++pending;
+			});
+		}
+	}
+
+	return INT_MAX;
+}
+
+// Monotone radix heap. Bucket 0 holds the keys equal to the last extracted
+// minimum and bucket i the keys whose highest bit differing from it is bit i - 1.
+// When bucket 0 runs dry, the first non-empty bucket is redistributed around
+// its own minimum, which sends every key to a strictly lower bucket, so each
+// entry moves at most 64 times over the whole search.
+size_t Graph::dijkstra_radix_heap(size_t start, size_t end, std::vector<size_t>& path, TraversalWorkspace& workspace) const
+{
+	const size_t BUCKET_COUNT = 65;
 
-			return distances[current.vertex];
+	workspace.reset(V);
+	std::vector<std::vector<std::pair<size_t, size_t>>>& buckets = workspace.buckets(BUCKET_COUNT);
+
+	size_t last = 0;
+	// Bit length of key ^ last, by binary search over the shift
+	auto bucketOf = [&last](size_t key) {
+		uint64_t diff = key ^ last;
+		size_t index = 0;
+		for (size_t shift = 32; shift > 0; shift >>= 1)
+		{
+			if (diff >> shift)
+			{
+				diff >>= shift;
+				index += shift;
+			}
 		}
+		return index + (diff != 0);
+	};
+
+	workspace.setDistance(start, 0, start);
+	buckets[0].push_back({ 0, start });
+	size_t pending = 1;
 
-		for (int i = 0; i < adj[current.vertex].size(); ++i)
+	while (pending > 0)
+	{
+		if (buckets[0].empty())
 		{
-			size_t currentNeighbor = adj[current.vertex][i].first;
+			size_t i = 1;
+			while (buckets[i].empty())
+				++i;
 
-			size_t newDist = current.distFromStart + adj[current.vertex][i].second;
-			if (newDist < distances[currentNeighbor])
+			last = buckets[i][0].first;
+			for (const auto& entry : buckets[i])
+				last = std::min(last, entry.first);
+
+			// Entries superseded by a shorter distance are dropped instead of moved
+			for (const auto& entry : buckets[i])
 			{
-				distances[currentNeighbor] = newDist;
-				q.push({ currentNeighbor, newDist });
-				prevs[currentNeighbor] = current.vertex;
+				if (entry.first == workspace.distance(entry.second))
+					buckets[bucketOf(entry.first)].push_back(entry);
+				else
+					--pending;
 			}
+			buckets[i].clear();
+
+			if (buckets[0].empty())
+				continue;
+		}
+
+		std::pair<size_t, size_t> current = buckets[0].back();
+		buckets[0].pop_back();
+		--pending;
+
+		size_t currentVertex = current.second;
+		if (current.first > workspace.distance(currentVertex))
+			continue;
+
+		if (currentVertex == end)
+		{
+			reconstruct_path(start, end, path, workspace);
+			return current.first;
+		}
+
+		relax(adj[currentVertex], currentVertex, current.first, workspace, [&](size_t newDist, size_t neighbor) {
+			buckets[bucketOf(newDist)].push_back({ newDist, neighbor });
+			++pending;
+		});
+	}
+
+	return INT_MAX;
+}
+
+template<typename Heuristic>
+size_t Graph::astar(size_t start, size_t end, Heuristic heuristic, std::vector<size_t>& path) const
+{
+	TraversalWorkspace workspace(V);
+	return astar(start, end, heuristic, path, workspace);
+}
+
+// Dijkstra ordered by distance from start plus the estimated distance to end,
+// so vertices leading away from end are settled late or never. The heuristic
+// is a template parameter and is inlined into the loop. A heuristic that is
+// admissible but not consistent is still exact: a vertex whose distance
+// improves after it was popped is simply pushed again.
+template<typename Heuristic>
+size_t Graph::astar(size_t start, size_t end, Heuristic heuristic, std::vector<size_t>& path, TraversalWorkspace& workspace) const
+{
+	// (distance from start + estimate to end, vertex), smallest on top
+	using vertexAndDistancePair = std::pair<size_t, size_t>;
+	std::greater<vertexAndDistancePair> later;
+
+	workspace.reset(V);
+	std::vector<vertexAndDistancePair>& q = workspace.heap();
+
+	workspace.setDistance(start, 0, start);
+	q.push_back({ heuristic(start, end), start });
+
+	while (!q.empty())
+	{
+		std::pop_heap(q.begin(), q.end(), later);
+		vertexAndDistancePair current = q.back();
+		q.pop_back();
+
+		size_t currentVertex = current.second;
+		size_t currentDist = workspace.distance(currentVertex);
+		if (current.first > currentDist + heuristic(currentVertex, end))
+			continue;
+
+		if (currentVertex == end)
+		{
+			reconstruct_path(start, end, path, workspace);
+			return currentDist;
 		}
+
+		relax(adj[currentVertex], currentVertex, currentDist, workspace, [&](size_t newDist, size_t neighbor) {
+			q.push_back({ newDist + heuristic(neighbor, end), neighbor });
+			std::push_heap(q.begin(), q.end(), later);
+		});
 	}
 
 	return INT_MAX;
 }
 
-int main()
+ShortestPathTree Graph::shortest_distances(size_t source) const
+{
+	return shortest_paths_tree({ source }, adj);
+}
+
+ShortestPathTree Graph::shortest_distances_multi_source(const std::vector<size_t>& sources) const
+{
+	return shortest_paths_tree(sources, adj);
+}
+
+// Dijkstra without a target. All sources start in the queue at distance 0,
+// which is the same as one search from a virtual vertex joined to each of
+// them by a zero weight edge. The labels live in a workspace like every other
+// search's and are copied into the tree at the end.
+ShortestPathTree Graph::shortest_paths_tree(const std::vector<size_t>& sources, const std::vector<std::vector<std::pair<int, int>>>& edges) const
+{
+	using vertexAndDistancePair = std::pair<size_t, size_t>;
+	std::priority_queue<vertexAndDistancePair, std::vector<vertexAndDistancePair>, std::greater<vertexAndDistancePair>> q;
+
+	TraversalWorkspace workspace(V);
+	for (size_t source : sources)
+	{
+		workspace.setDistance(source, 0, source);
+		q.push({ 0, source });
+	}
+
+	while (!q.empty())
+	{
+		vertexAndDistancePair current = q.top();
+		q.pop();
+		if (current.first > workspace.distance(current.second))
+			continue;
+
+		relax(edges[current.second], current.second, current.first, workspace, [&](size_t newDist, size_t neighbor) {
+			q.push({ newDist, neighbor });
+		});
+	}
+
+	ShortestPathTree result;
+	result.distances.resize(V);
+	result.parents.resize(V);
+	for (size_t v = 0; v < V; ++v)
+	{
+		result.distances[v] = workspace.distance(v);
+		result.parents[v] = workspace.parent(v);
+	}
+
+	return result;
+}
+
+// Picks landmarks by farthest-point selection: nearest[v] is the multi-source
+// distance from the landmarks chosen so far, and the next landmark is the
+// vertex that maximizes it. Vertices no landmark reaches count as farthest,
+// so every component gets a landmark before any gets a second one.
+LandmarkHeuristic Graph::landmarks(size_t count) const
 {
+	LandmarkHeuristic result;
+	count = std::min(count, V);
+	result.landmarkCount = count;
+	result.fromLandmark.resize(V * count);
+	if (oriented)
+		result.toLandmark.resize(V * count);
+
+	std::vector<size_t> nearest(V, INT_MAX);
+	size_t next = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		result.landmarkIds.push_back(next);
+
+		std::vector<size_t> from = shortest_paths_tree({ next }, adj).distances;
+		for (size_t v = 0; v < V; ++v)
+		{
+			result.fromLandmark[v * count + i] = from[v];
+			nearest[v] = std::min(nearest[v], from[v]);
+		}
+
+		if (oriented)
+		{
+			std::vector<size_t> to = shortest_paths_tree({ next }, radj).distances;
+			for (size_t v = 0; v < V; ++v)
+				result.toLandmark[v * count + i] = to[v];
+		}
+
+		for (size_t v = 0; v < V; ++v)
+		{
+			if (nearest[v] > nearest[next])
+				next = v;
+		}
+	}
+
+	return result;
+}
+
+// Landmarks that cannot reach one of the two vertices give no bound and are skipped
+size_t LandmarkHeuristic::operator()(size_t vertex, size_t end) const
+{
+	const size_t* fromVertex = fromLandmark.data() + vertex * landmarkCount;
+	const size_t* fromEnd = fromLandmark.data() + end * landmarkCount;
+	const size_t* toVertex = toLandmark.empty() ? fromVertex : toLandmark.data() + vertex * landmarkCount;
+	const size_t* toEnd = toLandmark.empty() ? fromEnd : toLandmark.data() + end * landmarkCount;
+
+	size_t bound = 0;
+	for (size_t i = 0; i < landmarkCount; ++i)
+	{
+		if (fromEnd[i] != UNREACHABLE && fromVertex[i] < fromEnd[i])
+			bound = std::max(bound, fromEnd[i] - fromVertex[i]);
+		if (toVertex[i] != UNREACHABLE && toEnd[i] < toVertex[i])
+			bound = std::max(bound, toVertex[i] - toEnd[i]);
+	}
+
+	return bound;
+}
+
+const std::vector<size_t>& LandmarkHeuristic::getLandmarks() const
+{
+	return landmarkIds;
+}
+
+// One search answers every query with the same source. The distinct targets
+// are kept sorted in the workspace's frontier buffer, so checking whether a
+// settled vertex is one of them is a binary search and nothing is allocated.
+void Graph::dijkstra_targets(size_t start, const size_t* targets, size_t count, size_t* distances, TraversalWorkspace& workspace) const
+{
+	using vertexAndDistancePair = std::pair<size_t, size_t>;
+	std::greater<vertexAndDistancePair> later;
+
+	workspace.reset(V);
+	std::vector<vertexAndDistancePair>& q = workspace.heap();
+	std::vector<size_t>& remaining = workspace.frontier();
+
+	remaining.assign(targets, targets + count);
+	std::sort(remaining.begin(), remaining.end());
+	remaining.erase(std::unique(remaining.begin(), remaining.end()), remaining.end());
+	size_t unsettled = remaining.size();
+
+	workspace.setDistance(start, 0, start);
+	q.push_back({ 0, start });
+
+	while (!q.empty() && unsettled > 0)
+	{
+		std::pop_heap(q.begin(), q.end(), later);
+		vertexAndDistancePair current = q.back();
+		q.pop_back();
+
+		size_t currentVertex = current.second;
+		if (current.first > workspace.distance(currentVertex))
+			continue;
+
+		if (std::binary_search(remaining.begin(), remaining.end(), currentVertex))
+			--unsettled;
+
+		relax(adj[currentVertex], currentVertex, current.first, workspace, [&](size_t newDist, size_t neighbor) {
+			q.push_back({ newDist, neighbor });
+			std::push_heap(q.begin(), q.end(), later);
+		});
+	}
+
+	for (size_t i = 0; i < count; ++i)
+		distances[i] = workspace.distance(targets[i]);
+}
+
+size_t Graph::dijkstra_bidirectional(size_t start, size_t end, std::vector<size_t>& path) const
+{
+	TraversalWorkspace forward(V), backward(V);
+	return dijkstra_bidirectional(start, end, path, forward, backward);
+}
+
+// Runs Dijkstra forward from start over adj and backward from end over the
+// incoming edges, settling one vertex at a time on the side with the smaller
+// heap. Every relaxation that reaches a vertex labelled by the other search
+// closes a start-end path and may improve best. The search stops once the two
+// heap minimums add up to at least best: any path not yet seen has to leave
+// both balls and so cannot be shorter.
+size_t Graph::dijkstra_bidirectional(size_t start, size_t end, std::vector<size_t>& path,
+	TraversalWorkspace& forward, TraversalWorkspace& backward) const
+{
+	// (distance from start or to end, vertex), smallest distance on top
+	using vertexAndDistancePair = std::pair<size_t, size_t>;
+	std::greater<vertexAndDistancePair> later;
+
+	const std::vector<std::vector<std::pair<int, int>>>& incoming = oriented ? radj : adj;
+
+	forward.reset(V);
+	backward.reset(V);
+	std::vector<vertexAndDistancePair>& forwardQueue = forward.heap();
+	std::vector<vertexAndDistancePair>& backwardQueue = backward.heap();
+
+	forward.setDistance(start, 0, start);
+	backward.setDistance(end, 0, end);
+	forwardQueue.push_back({ 0, start });
+	backwardQueue.push_back({ 0, end });
+
+	size_t best = start == end ? 0 : INT_MAX;
+	size_t meet = start;
+
+	// Entries superseded by a shorter distance would understate the heap minimum
+	auto dropStale = [&later](std::vector<vertexAndDistancePair>& q, const TraversalWorkspace& workspace) {
+		while (!q.empty() && q.front().first > workspace.distance(q.front().second))
+		{
+			std::pop_heap(q.begin(), q.end(), later);
+			q.pop_back();
+		}
+	};
+
+	while (true)
+	{
+		dropStale(forwardQueue, forward);
+		dropStale(backwardQueue, backward);
+
+		if (forwardQueue.empty() || backwardQueue.empty())
+			break;
+		if (forwardQueue.front().first + backwardQueue.front().first >= best)
+			break;
+
+		bool isForward = forwardQueue.size() <= backwardQueue.size();
+		TraversalWorkspace& side = isForward ? forward : backward;
+		const TraversalWorkspace& other = isForward ? backward : forward;
+		std::vector<vertexAndDistancePair>& q = isForward ? forwardQueue : backwardQueue;
+		const std::vector<std::vector<std::pair<int, int>>>& edges = isForward ? adj : incoming;
+
+		std::pop_heap(q.begin(), q.end(), later);
+		vertexAndDistancePair current = q.back();
+		q.pop_back();
+
+		size_t currentVertex = current.second;
+		relax(edges[currentVertex], currentVertex, current.first, side, [&](size_t newDist, size_t neighbor) {
+			q.push_back({ newDist, neighbor });
+			std::push_heap(q.begin(), q.end(), later);
+
+			size_t otherDist = other.distance(neighbor);
+			if (otherDist != UNREACHABLE && newDist + otherDist < best)
+			{
+				best = newDist + otherDist;
+				meet = neighbor;
+			}
+		});
+	}
+
+	if (best == INT_MAX)
+		return INT_MAX;
+
+	for (size_t v = meet; v != start; v = forward.parent(v))
+		path.push_back(v);
+	path.push_back(start);
+	std::reverse(path.begin(), path.end());
+
+	for (size_t v = meet; v != end; )
+	{
+		v = backward.parent(v);
+		path.push_back(v);
+	}
+
+	return best;
+}
+
+// Point to point queries on a side x side grid with random weights in
+// [10, 20], a stand-in for a road network: dijkstra against astar with no
+// heuristic and with ALT heuristics of 4, 8 and 16 landmarks. Reports the
+// mean query time and the mean number of vertices each query labelled
+// (settled or left in the queue), which is what a heuristic saves.
+void benchmarkShortestPaths(size_t side)
+{
+	const size_t QUERIES = 100;
+
+	std::mt19937 random(7);
+	std::uniform_int_distribution<int> anyWeight(10, 20);
+
+	size_t V = side * side;
+	Graph g(V, false);
+	for (size_t row = 0; row < side; ++row)
+	{
+		for (size_t column = 0; column < side; ++column)
+		{
+			size_t v = row * side + column;
+			if (column + 1 < side)
+				g.addEdge(v, v + 1, anyWeight(random));
+			if (row + 1 < side)
+				g.addEdge(v, v + side, anyWeight(random));
+		}
+	}
+
+	std::uniform_int_distribution<size_t> anyVertex(0, V - 1);
+	std::vector<std::pair<size_t, size_t>> queries(QUERIES);
+	for (auto& query : queries)
+		query = { anyVertex(random), anyVertex(random) };
+
+	TraversalWorkspace workspace(V);
+	auto labelled = [&]() {
+		size_t count = 0;
+		for (size_t v = 0; v < V; ++v)
+			count += workspace.distance(v) != UNREACHABLE;
+		return count;
+	};
+
+	std::vector<size_t> expected(QUERIES);
+	auto run = [&](const std::string& name, auto search) {
+		double time = 0;
+		size_t reached = 0;
+		bool mismatch = false;
+		for (size_t q = 0; q < QUERIES; ++q)
+		{
+			std::vector<size_t> path;
+			size_t dist = 0;
+			time += timeSeconds([&] { dist = search(queries[q].first, queries[q].second, path); });
+			reached += labelled();
+
+			if (name == "dijkstra")
+				expected[q] = dist;
+			mismatch = mismatch || dist != expected[q];
+		}
+
+		std::cout << name << "\t" << time / QUERIES * 1e3 << " ms\t" << reached / QUERIES << " vertices"
+			<< (mismatch ? "\tMISMATCH" : "") << std::endl;
+	};
+
+	std::cout << V << " vertices, " << QUERIES << " random queries" << std::endl;
+	run("dijkstra", [&](size_t start, size_t end, std::vector<size_t>& path) {
+		return g.dijkstra(start, end, path, workspace);
+	});
+	run("A* zero", [&](size_t start, size_t end, std::vector<size_t>& path) {
+		return g.astar(start, end, ZeroHeuristic(), path, workspace);
+	});
+	for (size_t count : { 4, 8, 16 })
+	{
+		LandmarkHeuristic alt;
+		double preprocessing = timeSeconds([&] { alt = g.landmarks(count); });
+		std::cout << count << " landmarks chosen in " << preprocessing << " s" << std::endl;
+		run("ALT " + std::to_string(count), [&](size_t start, size_t end, std::vector<size_t>& path) {
+			return g.astar(start, end, alt, path, workspace);
+		});
+	}
+}
+
+// Run with --benchmark [side] to compare the searches on a side x side grid
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && std::string(argv[1]) == "--benchmark")
+	{
+		benchmarkShortestPaths(argc > 2 ? std::stoul(argv[2]) : 500);
+		return 0;
+	}
+
 	Graph g(9, false);
 	g.addEdge(0, 1, 4);
 	g.addEdge(0, 7, 8);
@@ -111,5 +740,24 @@ int main()
 		std::cout << std::endl << std::endl << std::endl;
 	}
 
+	{ //A* with landmark heuristic example
+		LandmarkHeuristic alt = g.landmarks(2);
+		std::vector<size_t> path;
+		std::cout << "Shortest weight path from 0 to 4(with A* and 2 landmarks):" << g.astar(0, 4, alt, path) << std::endl;
+		std::cout << "Path : ";
+		for (size_t i = 0; i < path.size(); i++)
+			std::cout << path[i] << " ";
+		std::cout << std::endl << std::endl << std::endl;
+	}
+
+	{ //Bidirectional Dijkstra example
+		std::vector<size_t> path;
+		std::cout << "Shortest weight path from 0 to 4(with bidirectional Dijkstra):" << g.dijkstra_bidirectional(0, 4, path) << std::endl;
+		std::cout << "Path : ";
+		for (size_t i = 0; i < path.size(); i++)
+			std::cout << path[i] << " ";
+		std::cout << std::endl << std::endl << std::endl;
+	}
+
 
 }
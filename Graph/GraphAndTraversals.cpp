@@ -2,6 +2,16 @@
 #include <vector>
 #include <queue>
 #include <stack>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include "GraphTypes.h"
+#include "TraversalWorkspace.h"
+#include "CsrGraph.h"
+#include "ParallelComponents.h"
+#include "RmatGraph.h"
+#include "Benchmark.h"
 
 class Graph
 {
@@ -14,33 +24,46 @@ public:
 
 	void BFS(size_t start) const;
 	void DFS_ITER(size_t start) const;
+	void DFS_ITER(size_t start, TraversalWorkspace& workspace) const;
 	void DFS_REC(size_t start) const;
 	int BFS_shortest_path(size_t start, size_t end) const;
+	int BFS_shortest_path(size_t start, size_t end, TraversalWorkspace& workspace) const;
 	int BFS_shortest_path_vector(size_t start, size_t end) const;
+	int BFS_shortest_path_bidirectional(size_t start, size_t end, std::vector<size_t>& path) const;
+	int BFS_shortest_path_bidirectional(size_t start, size_t end, std::vector<size_t>& path,
+		TraversalWorkspace& forward, TraversalWorkspace& backward) const;
+	ShortestPathTree BFS_direction_optimizing(size_t start) const;
+	ShortestPathTree shortest_distances(size_t source) const;
+	ShortestPathTree shortest_distances_multi_source(const std::vector<size_t>& sources) const;
 
 	bool containsCycle() const;
 	std::vector<size_t> topoSort() const;
+	size_t stronglyConnectedComponents(std::vector<size_t>& component) const;
 	size_t getConnectedComponentsCount() const;
 
 private:
 
 	std::vector<std::vector<int>> adj;
+	std::vector<std::vector<int>> radj; // incoming edges, oriented graphs only
 	bool oriented;
+	size_t edgeCount = 0;
 
-	void dfs_help_rec(size_t start, std::vector<bool>& visited, std::vector<size_t>& result) const;
-	bool contains_cycle_rec(size_t start, std::vector<bool>& visited, std::vector<bool>& stack) const;
-	void topo_sort_rec(size_t start, std::vector<bool>& visited, std::vector<size_t>& st) const;
-	void connected_components_bfs(size_t start, std::vector<bool>& visited) const;
+	size_t bfs_direction_optimizing(size_t start, size_t end, std::vector<size_t>& distances,
+		std::vector<size_t>& parents, size_t& unexploredEdges) const;
 
 };
 
-Graph::Graph(size_t vertexCount, bool isOriented) : adj(vertexCount), oriented(isOriented) {}
+Graph::Graph(size_t vertexCount, bool isOriented) : adj(vertexCount), radj(isOriented ? vertexCount : 0), oriented(isOriented) {}
 
 void Graph::addEdge(size_t start, size_t end)
 {
 	adj[start].push_back((int)end);
-	if (oriented)
+	if (!oriented)
 		adj[end].push_back((int)start);
+	else
+		radj[end].push_back((int)start);
+
+	edgeCount += oriented ? 1 : 2;
 }
 
 void Graph::BFS(size_t start) const
@@ -71,221 +94,621 @@ void Graph::BFS(size_t start) const
 
 void Graph::DFS_ITER(size_t start) const
 {
-	std::vector<bool> visited(adj.size(), false);
+	TraversalWorkspace workspace(adj.size());
+	DFS_ITER(start, workspace);
+}
 
-	std::stack<size_t> s;
-	s.push(start);
+void Graph::DFS_ITER(size_t start, TraversalWorkspace& workspace) const
+{
+	workspace.reset(adj.size());
+
+	std::vector<size_t>& s = workspace.frontier();
+	s.push_back(start);
 
 	while (!s.empty())
 	{
-		size_t current = s.top();
-		s.pop();
+		size_t current = s.back();
+		s.pop_back();
 
-		if (visited[current])
+		if (workspace.isVisited(current))
 			continue;
 
-		visited[current] = true;
+		workspace.visit(current);
 		// Particular code for task
 
 		for (auto neighbor : adj[current])
 		{
-			s.push(neighbor);
+			s.push_back(neighbor);
 		}
 	}
 }
 
-void Graph::dfs_help_rec(size_t curr, std::vector<bool>& visited, std::vector<size_t>& result) const
+// Visits vertices in the same order as the recursive formulation, but keeps
+// the (vertex, next edge) frames on an explicit stack, so the depth of the
+// search is not limited by the call stack.
+void Graph::DFS_REC(size_t start) const
 {
-	visited[curr] = true;
+	std::vector<bool> visited(adj.size(), false);
+	std::vector<size_t> result; // In case of a task
+	std::vector<std::pair<size_t, size_t>> s;
+
+	visited[start] = true;
 	// Code for task
-	for (auto neighbor : adj[curr])
+	s.push_back({ start, 0 });
+
+	while (!s.empty())
 	{
+		auto& top = s.back();
+		if (top.second == adj[top.first].size())
+		{
+			s.pop_back();
+			continue;
+		}
+
+		size_t neighbor = adj[top.first][top.second++];
 		if (!visited[neighbor])
-			dfs_help_rec(neighbor, visited, result);
+		{
+			visited[neighbor] = true;
+			// Code for task
+			s.push_back({ neighbor, 0 });
+		}
 	}
 }
 
-void Graph::DFS_REC(size_t start) const
+int Graph::BFS_shortest_path(size_t start, size_t end) const
 {
-	std::vector<bool> visited(adj.size(), false);
-	std::vector<size_t> result; // In case of a task
+	if (start == end)
+		return 0;
+
+	std::vector<size_t> distances(adj.size(), UNREACHABLE);
+	std::vector<size_t> parents(adj.size(), UNREACHABLE);
+	size_t unexploredEdges = edgeCount;
 
-	dfs_help_rec(start, visited, result);
+	size_t dist = bfs_direction_optimizing(start, end, distances, parents, unexploredEdges);
+	return dist == UNREACHABLE ? -1 : (int)dist;
 }
 
-int Graph::BFS_shortest_path(size_t start, size_t end) const
+// Level vectors are what bfs_direction_optimizing keeps anyway, so this is
+// the same search as BFS_shortest_path
+int Graph::BFS_shortest_path_vector(size_t start, size_t end) const
+{
+	return BFS_shortest_path(start, end);
+}
+
+// Direction-optimizing BFS (Beamer, Asanovic, Patterson). Levels are expanded
+// top-down from a queue while the frontier is small. Once the edges leaving the
+// frontier outnumber a fraction of the edges still unexplored, it switches to
+// bottom-up steps: every unvisited vertex looks for a parent in the frontier
+// bitmap and stops at the first one, which skips most edges on the wide middle
+// levels of low-diameter graphs. It switches back when the frontier shrinks.
+// A bottom-up step sweeps all V vertices, so it is only taken for frontiers of
+// more than V / BETA vertices. Every step of such a phase but the last then
+// claims about that many vertices, so searches that share the arrays, one per
+// component, do O(BETA * V) bottom-up work in total however many components
+// there are.
+//
+// Vertices with a distance other than UNREACHABLE count as visited, which lets
+// several calls share the arrays. unexploredEdges is the sum of the
+// out-degrees of unvisited vertices and is kept up to date. Stops early once
+// end is reached and returns its distance (UNREACHABLE if it was not reached).
+size_t Graph::bfs_direction_optimizing(size_t start, size_t end, std::vector<size_t>& distances,
+	std::vector<size_t>& parents, size_t& unexploredEdges) const
 {
+	const size_t ALPHA = 14;
+	const size_t BETA = 24;
+	const std::vector<std::vector<int>>& incoming = oriented ? radj : adj;
+	size_t V = adj.size();
+
+	distances[start] = 0;
+	parents[start] = start;
 	if (start == end)
 		return 0;
 
-	std::vector<bool> visited(adj.size(), false);
-	std::queue<size_t> q;
-	q.push(start);
-	visited[start] = true;
-
-	int dist = 0;
+	std::vector<size_t> frontier = { start };
+	size_t scoutCount = adj[start].size();
+	unexploredEdges -= scoutCount;
+	size_t level = 0;
 
-	while (!q.empty())
+	while (!frontier.empty())
 	{
-		size_t currentLevelSize = q.size();
-		for (size_t i = 0; i < currentLevelSize; ++i)
+		if (scoutCount > unexploredEdges / ALPHA && frontier.size() > V / BETA)
 		{
-			size_t currentVertex = q.front();
-			q.pop();
-
-			for (auto neighbor : adj[currentVertex])
+			std::vector<uint64_t> current((V + 63) / 64, 0);
+			std::vector<uint64_t> next((V + 63) / 64, 0);
+			for (size_t v : frontier)
+				current[v / 64] |= (uint64_t)1 << (v % 64);
+
+			size_t awake = frontier.size();
+			size_t previousAwake;
+			do
 			{
-				if (visited[neighbor])
-					continue;
-				if (neighbor == end)
-					return dist + 1;
-
-				q.push(neighbor);
-				visited[neighbor] = true;
+				previousAwake = awake;
+				awake = 0;
+				++level;
+
+				for (size_t v = 0; v < V; ++v)
+				{
+					if (distances[v] != UNREACHABLE)
+						continue;
+
+					for (int u : incoming[v])
+					{
+						if (current[u / 64] & ((uint64_t)1 << (u % 64)))
+						{
+							distances[v] = level;
+							parents[v] = u;
+							next[v / 64] |= (uint64_t)1 << (v % 64);
+							unexploredEdges -= adj[v].size();
+							++awake;
+							break;
+						}
+					}
+				}
+
+				if (end < V && distances[end] != UNREACHABLE)
+					return distances[end];
+
+				current.swap(next);
+				std::fill(next.begin(), next.end(), 0);
+			} while (awake > 0 && (awake >= previousAwake || awake > V / BETA));
+
+			frontier.clear();
+			scoutCount = 0;
+			for (size_t v = 0; v < V; ++v)
+			{
+				if (current[v / 64] & ((uint64_t)1 << (v % 64)))
+				{
+					frontier.push_back(v);
+					scoutCount += adj[v].size();
+				}
 			}
 		}
+		else
+		{
+			std::vector<size_t> next;
+			scoutCount = 0;
+			++level;
+
+			for (size_t u : frontier)
+			{
+				for (int v : adj[u])
+				{
+					if (distances[v] != UNREACHABLE)
+						continue;
+
+					distances[v] = level;
+					parents[v] = u;
+					if ((size_t)v == end)
+						return level;
+
+					next.push_back(v);
+					scoutCount += adj[v].size();
+				}
+			}
 
-		dist++;
+			unexploredEdges -= scoutCount;
+			frontier.swap(next);
+		}
 	}
 
-	return -1;
+	return end < V ? distances[end] : UNREACHABLE;
 }
 
-int Graph::BFS_shortest_path_vector(size_t start, size_t end) const
+ShortestPathTree Graph::BFS_direction_optimizing(size_t start) const
 {
-	std::vector<size_t> currLevel = { start };
-	size_t dist = 0;
-	std::vector<bool> visited(adj.size(), false);
+	ShortestPathTree result;
+	result.distances.assign(adj.size(), UNREACHABLE);
+	result.parents.assign(adj.size(), UNREACHABLE);
+	size_t unexploredEdges = edgeCount;
+
+	bfs_direction_optimizing(start, SIZE_MAX, result.distances, result.parents, unexploredEdges);
+	return result;
+}
+
+ShortestPathTree Graph::shortest_distances(size_t source) const
+{
+	return BFS_direction_optimizing(source);
+}
 
-	while (!currLevel.empty())
+// BFS with every source in the first level. Following parents from a vertex
+// leads to the source nearest to it.
+ShortestPathTree Graph::shortest_distances_multi_source(const std::vector<size_t>& sources) const
+{
+	ShortestPathTree result;
+	result.distances.assign(adj.size(), UNREACHABLE);
+	result.parents.assign(adj.size(), UNREACHABLE);
+
+	std::vector<size_t> q;
+	q.reserve(adj.size());
+	for (size_t source : sources)
 	{
-		std::vector<size_t> nextLevel;
+		if (result.distances[source] == 0)
+			continue;
+
+		result.distances[source] = 0;
+		result.parents[source] = source;
+		q.push_back(source);
+	}
 
-		for (size_t currNode : currLevel)
+	for (size_t head = 0; head < q.size(); ++head)
+	{
+		size_t currentVertex = q[head];
+		for (auto neighbor : adj[currentVertex])
 		{
-			for (size_t currNodeChild : adj[currNode])
-			{
-				if (visited[currNodeChild])
-					continue;
+			if (result.distances[neighbor] != UNREACHABLE)
+				continue;
 
-				visited[currNodeChild] = true;
-				if (currNodeChild == end)
-					return dist + 1;
-				else
-					nextLevel.push_back(currNodeChild);
-			}
+			result.distances[neighbor] = result.distances[currentVertex] + 1;
+			result.parents[neighbor] = currentVertex;
+			q.push_back(neighbor);
 		}
-
-		dist++;
-		currLevel.swap(nextLevel);
 	}
 
-	return -1;
+	return result;
 }
 
-bool Graph::contains_cycle_rec(size_t start, std::vector<bool>& visited, std::vector<bool>& stack) const
+// Top-down BFS that stops at end. With a reused workspace nothing is
+// proportional to the size of the graph, only to the vertices it reaches.
+int Graph::BFS_shortest_path(size_t start, size_t end, TraversalWorkspace& workspace) const
 {
-	if (!visited[start])
+	if (start == end)
+		return 0;
+
+	workspace.reset(adj.size());
+	std::vector<size_t>& q = workspace.frontier();
+	q.push_back(start);
+	workspace.setDistance(start, 0, start);
+
+	for (size_t head = 0; head < q.size(); ++head)
 	{
-		visited[start] = true;
-		stack[start] = true;
+		size_t currentVertex = q[head];
+		size_t dist = workspace.distance(currentVertex);
 
-		for (auto neighbor : adj[start])
+		for (auto neighbor : adj[currentVertex])
 		{
-			if (!visited[neighbor] && contains_cycle_rec(neighbor, visited, stack))
-				return true;
-			else if (stack[neighbor])
-				return true;
+			if (workspace.isVisited(neighbor))
+				continue;
+			if ((size_t)neighbor == end)
+				return (int)dist + 1;
+
+			workspace.setDistance(neighbor, dist + 1, currentVertex);
+			q.push_back(neighbor);
 		}
 	}
 
-	stack[start] = false;
-	return false;
+	return -1;
 }
 
-bool Graph::containsCycle() const
+int Graph::BFS_shortest_path_bidirectional(size_t start, size_t end, std::vector<size_t>& path) const
 {
-	std::vector<bool> visited(adj.size(), false);
-	std::vector<bool> inStack(adj.size(), false);
+	TraversalWorkspace forward(adj.size()), backward(adj.size());
+	return BFS_shortest_path_bidirectional(start, end, path, forward, backward);
+}
 
-	for (size_t i = 0; i < adj.size(); ++i)
+// Grows a BFS ball around start over adj and one around end over the incoming
+// edges, always expanding the side with the smaller frontier by a whole level.
+// A vertex labelled by both searches closes a path of length
+// forwardDist + backwardDist. Once the two radii add up to at least best - 1,
+// every shorter path would already have produced such a vertex, so best is final.
+int Graph::BFS_shortest_path_bidirectional(size_t start, size_t end, std::vector<size_t>& path,
+	TraversalWorkspace& forward, TraversalWorkspace& backward) const
+{
+	const std::vector<std::vector<int>>& incoming = oriented ? radj : adj;
+
+	forward.reset(adj.size());
+	backward.reset(adj.size());
+	forward.setDistance(start, 0, start);
+	backward.setDistance(end, 0, end);
+
+	std::vector<size_t>& forwardFrontier = forward.frontier();
+	std::vector<size_t>& backwardFrontier = backward.frontier();
+	forwardFrontier.push_back(start);
+	backwardFrontier.push_back(end);
+
+	size_t forwardRadius = 0, backwardRadius = 0;
+	size_t best = start == end ? 0 : UNREACHABLE;
+	size_t meet = start;
+	std::vector<size_t> next;
+
+	while (!forwardFrontier.empty() && !backwardFrontier.empty() && best > forwardRadius + backwardRadius + 1)
 	{
-		if(contains_cycle_rec(i, visited, inStack))
-			return true;
+		bool isForward = forwardFrontier.size() <= backwardFrontier.size();
+		TraversalWorkspace& side = isForward ? forward : backward;
+		const TraversalWorkspace& other = isForward ? backward : forward;
+		std::vector<size_t>& frontier = isForward ? forwardFrontier : backwardFrontier;
+		const std::vector<std::vector<int>>& edges = isForward ? adj : incoming;
+		size_t& radius = isForward ? forwardRadius : backwardRadius;
+
+		next.clear();
+		for (size_t currentVertex : frontier)
+		{
+			for (auto neighbor : edges[currentVertex])
+			{
+				if (side.isVisited(neighbor))
+					continue;
+
+				side.setDistance(neighbor, radius + 1, currentVertex);
+				next.push_back(neighbor);
+
+				size_t otherDist = other.distance(neighbor);
+				if (otherDist != UNREACHABLE && radius + 1 + otherDist < best)
+				{
+					best = radius + 1 + otherDist;
+					meet = neighbor;
+				}
+			}
+		}
+
+		frontier.swap(next);
+		++radius;
 	}
 
-	return false;
+	if (best == UNREACHABLE)
+		return -1;
+
+	for (size_t v = meet; v != start; v = forward.parent(v))
+		path.push_back(v);
+	path.push_back(start);
+	std::reverse(path.begin(), path.end());
+
+	for (size_t v = meet; v != end; )
+	{
+		v = backward.parent(v);
+		path.push_back(v);
+	}
+
+	return (int)best;
 }
 
-void Graph::topo_sort_rec(size_t start, std::vector<bool>& visited, std::vector<size_t>& st) const
+// DFS with an explicit stack, so path length is not limited by the call
+// stack. An edge to a vertex that is still open closes a cycle. An undirected
+// edge is stored at both ends, so in an undirected graph each vertex skips the
+// one copy that leads back to its DFS parent; a second edge to the parent is
+// a real cycle of length two.
+bool Graph::containsCycle() const
 {
-	visited[start] = true;
-	for (size_t i = 0; i < adj[start].size(); ++i)
+	enum Color : uint8_t { White, Gray, Black };
+	struct Frame
+	{
+		size_t vertex;
+		size_t next;
+		size_t parent;
+		bool parentEdgeSkipped;
+	};
+
+	std::vector<Color> color(adj.size(), White);
+	std::vector<Frame> s;
+
+	for (size_t root = 0; root < adj.size(); ++root)
 	{
-		if (!visited[adj[start][i]])
-			topo_sort_rec(i, visited, st);
+		if (color[root] != White)
+			continue;
+
+		color[root] = Gray;
+		s.push_back({ root, 0, SIZE_MAX, false });
+
+		while (!s.empty())
+		{
+			Frame& top = s.back();
+			if (top.next == adj[top.vertex].size())
+			{
+				color[top.vertex] = Black;
+				s.pop_back();
+				continue;
+			}
+
+			size_t neighbor = adj[top.vertex][top.next++];
+			if (!oriented && neighbor == top.parent && !top.parentEdgeSkipped)
+			{
+				top.parentEdgeSkipped = true;
+				continue;
+			}
+
+			if (color[neighbor] == Gray)
+				return true;
+			if (color[neighbor] == White)
+			{
+				color[neighbor] = Gray;
+				s.push_back({ neighbor, 0, top.vertex, false });
+			}
+		}
 	}
-	st.push_back(start);
+
+	return false;
 }
 
+// Reverse DFS postorder, with an explicit stack. Only oriented graphs have a
+// topological order; on a graph with a cycle the result is not one.
 std::vector<size_t> Graph::topoSort() const
 {
-	std::vector<bool> visited(adj.size());
+	if (!oriented)
+		throw std::runtime_error("Topological sort needs an oriented graph!");
+
+	std::vector<bool> visited(adj.size(), false);
 	std::vector<size_t> result;
+	std::vector<std::pair<size_t, size_t>> s;
 
-	for (size_t i = 0; i < adj.size(); ++i)
+	for (size_t root = 0; root < adj.size(); ++root)
 	{
-		if (!visited[i])
-			topo_sort_rec(i, visited, result);
+		if (visited[root])
+			continue;
+
+		visited[root] = true;
+		s.push_back({ root, 0 });
+
+		while (!s.empty())
+		{
+			auto& top = s.back();
+			if (top.second == adj[top.first].size())
+			{
+				result.push_back(top.first);
+				s.pop_back();
+				continue;
+			}
+
+			size_t neighbor = adj[top.first][top.second++];
+			if (!visited[neighbor])
+			{
+				visited[neighbor] = true;
+				s.push_back({ neighbor, 0 });
+			}
+		}
 	}
 
 	std::reverse(result.begin(), result.end());
-
 	return result;
 }
 
-void Graph::connected_components_bfs(size_t start, std::vector<bool>& visited) const
+// Pearce's variant of Tarjan's algorithm, with an explicit stack. Instead of
+// separate index and lowlink arrays, each vertex keeps a single rank: the
+// lowest DFS index it can reach while it is open, and once its component is
+// finished a component number counted down from V - 1, which is above every
+// open index, so finished vertices never lower a rank again. The ranks are
+// kept in component itself, and the only other per-vertex state is one bit
+// for whether the vertex is still the root of its component.
+//
+// Fills component[v] for every vertex and returns the number of components.
+// Components are numbered in the order they are finished, which is a reverse
+// topological order of the condensation: edges only go from a component to
+// one with a smaller number. Edges of an unoriented graph go both ways, so
+// its components are the connected components.
+size_t Graph::stronglyConnectedComponents(std::vector<size_t>& component) const
 {
-	std::queue<size_t> q;
-	q.push(start);
-	visited[start] = true;
+	size_t V = adj.size();
+	std::vector<size_t>& rank = component;
+	rank.assign(V, 0);
 
-	while (!q.empty())
+	std::vector<bool> isRoot(V, false);
+	std::vector<std::pair<size_t, size_t>> s;
+	std::vector<size_t> open; // finished vertices waiting for their component's root
+	size_t index = 1;
+	size_t next = V - 1;
+
+	for (size_t start = 0; start < V; ++start)
 	{
-		size_t currrentVertex = q.front();
-		q.pop();
+		if (rank[start] != 0)
+			continue;
+
+		rank[start] = index++;
+		isRoot[start] = true;
+		s.push_back({ start, 0 });
 
-		for (int i = 0; i < adj[currrentVertex].size(); ++i)
+		while (!s.empty())
 		{
-			size_t neighbor = adj[currrentVertex][i];
-			if (visited[neighbor])
+			auto& top = s.back();
+			size_t v = top.first;
+
+			if (top.second < adj[v].size())
+			{
+				size_t neighbor = adj[v][top.second++];
+				if (rank[neighbor] == 0)
+				{
+					rank[neighbor] = index++;
+					isRoot[neighbor] = true;
+					s.push_back({ neighbor, 0 });
+				}
+				else if (rank[neighbor] < rank[v])
+				{
+					rank[v] = rank[neighbor];
+					isRoot[v] = false;
+				}
 				continue;
+			}
 
-			visited[neighbor] = true;
-			q.push(neighbor);
+			s.pop_back();
+			if (isRoot[v])
+			{
+				--index;
+				while (!open.empty() && rank[v] <= rank[open.back()])
+				{
+					rank[open.back()] = next;
+					open.pop_back();
+					--index;
+				}
+				rank[v] = next--;
+			}
+			else
+			{
+				open.push_back(v);
+			}
+
+			if (!s.empty() && rank[v] < rank[s.back().first])
+			{
+				rank[s.back().first] = rank[v];
+				isRoot[s.back().first] = false;
+			}
 		}
 	}
+
+	for (size_t v = 0; v < V; ++v)
+		component[v] = V - 1 - rank[v];
+
+	return V - 1 - next;
 }
 
+// The searches share one distance array, so the BFS of every component only
+// visits vertices that no earlier component reached.
 size_t Graph::getConnectedComponentsCount() const
 {
 	size_t connectedComponentsCount = 0;
-	std::vector<bool> visited(adj.size());
+	std::vector<size_t> distances(adj.size(), UNREACHABLE);
+	std::vector<size_t> parents(adj.size(), UNREACHABLE);
+	size_t unexploredEdges = edgeCount;
 
-	for (int i = 0; i < adj.size(); ++i)
+	for (size_t i = 0; i < adj.size(); ++i)
 	{
-		if (!visited[i])
+		if (distances[i] == UNREACHABLE)
 		{
 			connectedComponentsCount++;
-			connected_components_bfs(i, visited);
+			bfs_direction_optimizing(i, SIZE_MAX, distances, parents, unexploredEdges);
 		}
 	}
 
 	return connectedComponentsCount;
 }
 
-int main()
+// getConnectedComponentsCount against parallelConnectedComponents on an
+// undirected R-MAT graph of 2^scale vertices and 16 * 2^scale edges, which has
+// one giant component and many small ones. The parallel version runs on pools
+// of 1, 2, 4, ... threads up to every core, and both must find the same
+// number of components.
+void benchmarkComponents(size_t scale)
+{
+	const size_t EDGE_FACTOR = 16;
+
+	size_t V = (size_t)1 << scale;
+	std::vector<Edge> edges = rmatEdges(scale, EDGE_FACTOR, 1, 1);
+	Graph g(V, false);
+	for (const Edge& e : edges)
+		g.addEdge(std::get<0>(e), std::get<1>(e));
+	CsrGraph csr(V, edges, false);
+
+	size_t count = 0;
+	double bfsTime = timeSeconds([&] { count = g.getConnectedComponentsCount(); });
+	std::cout << V << " vertices, " << count << " components" << std::endl;
+	std::cout << "getConnectedComponentsCount\t" << bfsTime * 1e3 << " ms" << std::endl;
+
+	for (size_t threads : threadCounts())
+	{
+		ThreadPool pool(threads);
+		ConnectedComponents components;
+		double time = timeSeconds([&] { components = parallelConnectedComponents(csr, pool); });
+		size_t giant = *std::max_element(components.sizes.begin(), components.sizes.end());
+
+		std::cout << "Afforest, " << threads << " thr\t\t" << time * 1e3 << " ms\t" << bfsTime / time
+			<< "x, giant component of " << giant << (components.sizes.size() == count ? "" : "\tMISMATCH") << std::endl;
+	}
+}
+
+// Run with --benchmark [scale] to compare the connected components searches
+int main(int argc, char* argv[])
 {
+	if (argc > 1 && std::string(argv[1]) == "--benchmark")
+	{
+		benchmarkComponents(argc > 2 ? std::stoul(argv[2]) : 20);
+		return 0;
+	}
+
 	Graph g(9, false);
 
 	g.addEdge(0, 1);
@@ -302,5 +725,24 @@ int main()
 
 	g.BFS(0);
 
+	// Cycle detection on undirected graphs: the edge back to the parent does not count
+	Graph path(3, false);
+	path.addEdge(0, 1);
+	path.addEdge(1, 2);
+
+	Graph triangle(3, false);
+	triangle.addEdge(0, 1);
+	triangle.addEdge(1, 2);
+	triangle.addEdge(2, 0);
+
+	Graph doubleEdge(2, false);
+	doubleEdge.addEdge(0, 1);
+	doubleEdge.addEdge(0, 1);
+
+	std::cout << std::boolalpha;
+	std::cout << "Undirected path 0-1-2 contains a cycle: " << path.containsCycle() << std::endl;
+	std::cout << "Undirected triangle contains a cycle: " << triangle.containsCycle() << std::endl;
+	std::cout << "Two edges between 0 and 1 contain a cycle: " << doubleEdge.containsCycle() << std::endl;
+
 	return 0;
 }
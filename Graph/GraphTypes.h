@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <tuple>
+#include <climits>
+
+// (start, end, weight)
+using Edge = std::tuple<size_t, size_t, int>;
+
+struct MST
+{
+	std::vector<Edge> edges;
+	size_t sumOfWeights;
+};
+
+// Distance of a vertex that cannot be reached, the same value dijkstra returns
+const size_t UNREACHABLE = INT_MAX;
+
+// Result of a single-source search. The source is its own parent;
+// unreached vertices have distance and parent UNREACHABLE.
+struct ShortestPathTree
+{
+	std::vector<size_t> distances;
+	std::vector<size_t> parents;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include "GraphTypes.h"
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+// Level-synchronous BFS. Each frontier is split into chunks across the pool;
+// a vertex is claimed by the thread whose atomic fetch_or sets its visited
+// bit first, and only that thread writes its distance and parent, so the
+// result arrays need no locking. Every thread collects the vertices it claims
+// in its own buffer and the buffers are concatenated into the next frontier
+// between levels. An empty graph gives an empty tree; any other graph needs
+// a source below vertexCount().
+inline ShortestPathTree parallelBFS(const CsrGraph& g, size_t source, ThreadPool& pool)
+{
+	const size_t GRAIN = 64;
+	size_t V = g.vertexCount();
+
+	ShortestPathTree result;
+	if (V == 0)
+		return result;
+	if (source >= V)
+		throw std::runtime_error("Source vertex out of range!");
+
+	result.distances.assign(V, UNREACHABLE);
+	result.parents.assign(V, UNREACHABLE);
+
+	std::vector<std::atomic<uint64_t>> visited((V + 63) / 64);
+	for (auto& word : visited)
+		word.store(0, std::memory_order_relaxed);
+
+	visited[source / 64].store((uint64_t)1 << (source % 64), std::memory_order_relaxed);
+	result.distances[source] = 0;
+	result.parents[source] = source;
+
+	std::vector<uint32_t> frontier = { (uint32_t)source };
+	std::vector<std::vector<uint32_t>> claimed(pool.size());
+	std::vector<size_t> offsets(pool.size() + 1);
+
+	for (size_t level = 1; !frontier.empty(); ++level)
+	{
+		pool.parallelFor(frontier.size(), GRAIN, [&](size_t begin, size_t end, size_t thread) {
+			std::vector<uint32_t>& local = claimed[thread];
+			for (size_t f = begin; f < end; ++f)
+			{
+				uint32_t u = frontier[f];
+				for (size_t i = g.edgesBegin(u); i < g.edgesEnd(u); ++i)
+				{
+					size_t v = g.target(i);
+					uint64_t mask = (uint64_t)1 << (v % 64);
+
+					// A plain load first filters out most visited vertices
+					// without paying for a read-modify-write.
+					if (visited[v / 64].load(std::memory_order_relaxed) & mask)
+						continue;
+					if (visited[v / 64].fetch_or(mask, std::memory_order_relaxed) & mask)
+						continue;
+
+					result.distances[v] = level;
+					result.parents[v] = u;
+					local.push_back((uint32_t)v);
+				}
+			}
+		});
+
+		for (size_t t = 0; t < claimed.size(); ++t)
+			offsets[t + 1] = offsets[t] + claimed[t].size();
+
+		frontier.resize(offsets.back());
+		pool.parallelFor(claimed.size(), 1, [&](size_t begin, size_t end, size_t) {
+			for (size_t t = begin; t < end; ++t)
+			{
+				std::copy(claimed[t].begin(), claimed[t].end(), frontier.begin() + offsets[t]);
+				claimed[t].clear();
+			}
+		});
+	}
+
+	return result;
+}
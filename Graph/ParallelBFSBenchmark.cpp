@@ -0,0 +1,65 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "CsrGraph.h"
+#include "ParallelBFS.h"
+#include "RmatGraph.h"
+#include "Benchmark.h"
+
+// Scaling of parallelBFS on an undirected R-MAT graph of 2^scale vertices and
+// 16 * 2^scale edges (scale 20 unless given on the command line), for pools
+// of 1, 2, 4, ... threads up to every core. Every pool runs the same
+// SOURCES searches, started from vertices of the giant component; the
+// sequential CsrGraph::BFS from those sources is the baseline.
+
+const size_t EDGE_FACTOR = 16;
+const size_t SOURCES = 8;
+
+int main(int argc, char* argv[])
+{
+	size_t scale = argc > 1 ? std::stoul(argv[1]) : 20;
+	CsrGraph g((size_t)1 << scale, rmatEdges(scale, EDGE_FACTOR, 1, 1), false);
+
+	// The highest degree vertex is in the giant component; sources are taken
+	// from its BFS order at evenly spaced positions
+	size_t hub = 0;
+	for (size_t v = 0; v < g.vertexCount(); ++v)
+	{
+		if (g.edgesEnd(v) - g.edgesBegin(v) > g.edgesEnd(hub) - g.edgesBegin(hub))
+			hub = v;
+	}
+	std::vector<size_t> component = g.BFS(hub);
+	std::vector<size_t> sources;
+	for (size_t s = 0; s < SOURCES; ++s)
+		sources.push_back(component[s * component.size() / SOURCES]);
+
+	std::cout << g.vertexCount() << " vertices, " << g.edgeCount() << " adjacency entries, giant component of "
+		<< component.size() << " vertices" << std::endl;
+
+	double sequential = timeSeconds([&] {
+		for (size_t source : sources)
+			g.BFS(source);
+	});
+	std::cout << "CsrGraph::BFS\t" << sequential / SOURCES * 1e3 << " ms" << std::endl;
+
+	std::cout << "threads\tms\tspeedup over 1 thread" << std::endl;
+	double single = 0;
+	for (size_t threads : threadCounts())
+	{
+		ThreadPool pool(threads);
+		size_t reached = 0;
+		double time = 0;
+		for (size_t source : sources)
+		{
+			ShortestPathTree tree;
+			time += timeSeconds([&] { tree = parallelBFS(g, source, pool); });
+			for (size_t d : tree.distances)
+				reached += d != UNREACHABLE;
+		}
+		if (threads == 1)
+			single = time;
+
+		std::cout << threads << "\t" << time / SOURCES * 1e3 << "\t" << single / time << "x"
+			<< (reached == SOURCES * component.size() ? "" : "\tMISMATCH") << std::endl;
+	}
+}
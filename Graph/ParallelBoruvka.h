@@ -0,0 +1,162 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include "GraphTypes.h"
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+#include "../Disjoint Set/Concurrent/ConcurrentUnionFind.h"
+
+// Boruvka's algorithm. Every round, each component picks its cheapest edge to
+// another component and all the picked edges join the forest at once, which at
+// least halves the number of components. Picking is an atomic minimum on a
+// per-component key, joining goes through a lock-free union-find, and the edge
+// list is then contracted to the edges that still join two components, so
+// every step of a round runs across the pool. Ties between equal weights are
+// broken by edge position, which keeps the picked edges free of cycles.
+// Edges of an oriented graph are treated as undirected.
+inline MST parallelBoruvka(const CsrGraph& g, ThreadPool& pool)
+{
+	const size_t GRAIN = 1024;
+	const uint64_t NO_EDGE = UINT64_MAX;
+	size_t V = g.vertexCount();
+	size_t threads = pool.size();
+
+	struct BoruvkaEdge
+	{
+		uint32_t start;
+		uint32_t end;
+		int weight;
+		uint32_t id;
+	};
+
+	// The weight with its sign bit flipped orders like the signed weight, and
+	// the edge id in the low half makes every key distinct.
+	auto keyOf = [](const BoruvkaEdge& e) {
+		return ((uint64_t)((uint32_t)e.weight ^ 0x80000000u) << 32) | e.id;
+	};
+
+	std::vector<BoruvkaEdge> edges;
+	for (size_t u = 0; u < V; ++u)
+	{
+		for (size_t i = g.edgesBegin(u); i < g.edgesEnd(u); ++i)
+		{
+			size_t v = g.target(i);
+			if (u != v && (g.isOriented() || u < v))
+				edges.push_back({ (uint32_t)u, (uint32_t)v, g.weight(i), (uint32_t)edges.size() });
+		}
+	}
+
+	// Edges are relabelled as components merge and picked ones are found by
+	// id, so keep the original endpoints to report
+	std::vector<BoruvkaEdge> original = edges;
+
+	ConcurrentUnionFind uf(V);
+	std::vector<std::atomic<uint64_t>> cheapest(V);
+	pool.parallelFor(V, GRAIN, [&](size_t begin, size_t end, size_t) {
+		for (size_t v = begin; v < end; ++v)
+			cheapest[v].store(NO_EDGE, std::memory_order_relaxed);
+	});
+
+	auto offer = [&](uint32_t root, uint64_t key) {
+		uint64_t current = cheapest[root].load(std::memory_order_relaxed);
+		while (key < current && !cheapest[root].compare_exchange_weak(current, key, std::memory_order_relaxed))
+		{
+		}
+	};
+
+	std::vector<std::vector<BoruvkaEdge>> picked(threads);
+	std::vector<std::vector<uint32_t>> roots(threads);
+	std::vector<std::vector<BoruvkaEdge>> remaining(threads);
+	std::vector<uint32_t> activeRoots;
+	std::vector<size_t> offsets(threads + 1);
+
+	MST result;
+	result.sumOfWeights = 0;
+
+	while (!edges.empty())
+	{
+		// Cheapest edge out of every component; the thread that first lowers a
+		// component's key from NO_EDGE also records the component as active.
+		pool.parallelFor(edges.size(), GRAIN, [&](size_t begin, size_t end, size_t thread) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				uint32_t root1 = uf.getRoot(edges[i].start);
+				uint32_t root2 = uf.getRoot(edges[i].end);
+				uint64_t key = keyOf(edges[i]);
+
+				for (uint32_t root : { root1, root2 })
+				{
+					uint64_t expected = NO_EDGE;
+					if (cheapest[root].load(std::memory_order_relaxed) == NO_EDGE
+						&& cheapest[root].compare_exchange_strong(expected, key, std::memory_order_relaxed))
+						roots[thread].push_back(root);
+					else
+						offer(root, key);
+				}
+			}
+		});
+
+		activeRoots.clear();
+		for (auto& local : roots)
+		{
+			activeRoots.insert(activeRoots.end(), local.begin(), local.end());
+			local.clear();
+		}
+
+		// Two components that pick the same edge both try to join it, and the
+		// union-find lets exactly one of them succeed.
+		pool.parallelFor(activeRoots.size(), GRAIN, [&](size_t begin, size_t end, size_t thread) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				uint32_t root = activeRoots[i];
+				const BoruvkaEdge& e = original[cheapest[root].load(std::memory_order_relaxed) & 0xFFFFFFFFu];
+				if (uf.Union(e.start, e.end))
+					picked[thread].push_back(e);
+			}
+		});
+
+		pool.parallelFor(activeRoots.size(), GRAIN, [&](size_t begin, size_t end, size_t) {
+			for (size_t i = begin; i < end; ++i)
+				cheapest[activeRoots[i]].store(NO_EDGE, std::memory_order_relaxed);
+		});
+
+		for (auto& local : picked)
+		{
+			for (const BoruvkaEdge& e : local)
+			{
+				result.edges.push_back({ e.start, e.end, e.weight });
+				result.sumOfWeights += e.weight;
+			}
+			local.clear();
+		}
+
+		// Contract: only edges between two different components survive, and
+		// they are relabelled to the components' roots so that the next
+		// round's lookups are short
+		pool.parallelFor(edges.size(), GRAIN, [&](size_t begin, size_t end, size_t thread) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				uint32_t root1 = uf.getRoot(edges[i].start);
+				uint32_t root2 = uf.getRoot(edges[i].end);
+				if (root1 != root2)
+					remaining[thread].push_back({ root1, root2, edges[i].weight, edges[i].id });
+			}
+		});
+
+		for (size_t t = 0; t < threads; ++t)
+			offsets[t + 1] = offsets[t] + remaining[t].size();
+
+		edges.resize(offsets.back());
+		pool.parallelFor(threads, 1, [&](size_t begin, size_t end, size_t) {
+			for (size_t t = begin; t < end; ++t)
+			{
+				std::copy(remaining[t].begin(), remaining[t].end(), edges.begin() + offsets[t]);
+				remaining[t].clear();
+			}
+		});
+	}
+
+	return result;
+}
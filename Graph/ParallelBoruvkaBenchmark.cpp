@@ -0,0 +1,57 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <string>
+#include "GraphAlgorithms.cpp"
+#include "ParallelBoruvka.h"
+#include "RmatGraph.h"
+#include "Benchmark.h"
+
+// parallelBoruvka against Graph::Prim and Graph::Kruskal on an undirected
+// R-MAT graph of 2^scale vertices and 16 * 2^scale edges (scale 20 unless
+// given on the command line), with weights in [1, MAX_WEIGHT]. A cycle through
+// all vertices is added so the graph is connected and Prim, which grows one
+// tree from vertex 0, spans the same vertices as the other two. Boruvka runs
+// on pools of 1, 2, 4, ... threads up to every core; the time to convert the
+// graph to a CsrGraph is reported on its own. All results must have the same
+// total weight.
+
+const size_t EDGE_FACTOR = 16;
+const int MAX_WEIGHT = 1000000;
+
+int main(int argc, char* argv[])
+{
+	size_t scale = argc > 1 ? std::stoul(argv[1]) : 20;
+	size_t V = (size_t)1 << scale;
+
+	std::mt19937 random(3);
+	std::uniform_int_distribution<int> anyWeight(1, MAX_WEIGHT);
+
+	Graph g(V, false);
+	for (const Edge& e : rmatEdges(scale, EDGE_FACTOR, MAX_WEIGHT, 1))
+		g.addEdge(std::get<0>(e), std::get<1>(e), std::get<2>(e));
+	for (size_t v = 0; v < V; ++v)
+		g.addEdge(v, (v + 1) % V, anyWeight(random));
+
+	MST prim;
+	MST kruskal;
+	double primTime = timeSeconds([&] { prim = g.Prim(); });
+	double kruskalTime = timeSeconds([&] { kruskal = g.Kruskal(); });
+
+	std::cout << V << " vertices, minimum spanning tree weight " << kruskal.sumOfWeights << std::endl;
+	std::cout << "Graph::Prim\t" << primTime * 1e3 << " ms" << (prim.sumOfWeights == kruskal.sumOfWeights ? "" : "\tMISMATCH") << std::endl;
+	std::cout << "Graph::Kruskal\t" << kruskalTime * 1e3 << " ms" << std::endl;
+
+	CsrGraph csr(0, {}, false);
+	double conversionTime = timeSeconds([&] { csr = g.toCsr(); });
+	std::cout << "toCsr\t\t" << conversionTime * 1e3 << " ms" << std::endl;
+
+	for (size_t threads : threadCounts())
+	{
+		ThreadPool pool(threads);
+		MST boruvka;
+		double time = timeSeconds([&] { boruvka = parallelBoruvka(csr, pool); });
+		std::cout << "Boruvka, " << threads << " thr\t" << time * 1e3 << " ms\t" << kruskalTime / time << "x over Kruskal"
+			<< (boruvka.sumOfWeights == kruskal.sumOfWeights && boruvka.edges.size() == V - 1 ? "" : "\tMISMATCH") << std::endl;
+	}
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+#include "../Disjoint Set/Concurrent/ConcurrentUnionFind.h"
+
+// Components are numbered 0 .. sizes.size() - 1 in the order of their smallest
+// vertex; labels[v] is the component of v.
+struct ConnectedComponents
+{
+	std::vector<size_t> labels;
+	std::vector<size_t> sizes;
+};
+
+// Afforest (Sutton, Ben-Nun and Barak). Every vertex first unions with just
+// its first couple of neighbors, which on most graphs already joins the bulk
+// of the giant component. A random sample of vertices then finds that
+// component, and its vertices skip the rest of their edges: an edge between
+// two of its vertices changes nothing, and an edge leaving it is also seen
+// from the other end, by a vertex that does not skip. All unions go through
+// the lock-free union-find, so every phase runs across the pool. On an
+// oriented graph an edge is only stored at its start, so no vertex can skip
+// and the result is the weakly connected components.
+inline ConnectedComponents parallelConnectedComponents(const CsrGraph& g, ThreadPool& pool)
+{
+	const size_t GRAIN = 1024;
+	const size_t NEIGHBOR_ROUNDS = 2;
+	const size_t SAMPLES = 1024;
+	size_t V = g.vertexCount();
+
+	ConcurrentUnionFind uf(V);
+
+	for (size_t round = 0; round < NEIGHBOR_ROUNDS; ++round)
+	{
+		pool.parallelFor(V, GRAIN, [&](size_t begin, size_t end, size_t) {
+			for (size_t v = begin; v < end; ++v)
+			{
+				size_t i = g.edgesBegin(v) + round;
+				if (i < g.edgesEnd(v))
+					uf.Union((uint32_t)v, (uint32_t)g.target(i));
+			}
+		});
+	}
+
+	uint32_t largest = 0;
+	if (V != 0 && !g.isOriented())
+	{
+		std::mt19937 random(0x5EED);
+		std::unordered_map<uint32_t, size_t> counts;
+		size_t best = 0;
+		for (size_t s = 0; s < SAMPLES; ++s)
+		{
+			uint32_t root = uf.getRoot((uint32_t)(random() % V));
+			if (++counts[root] > best)
+			{
+				best = counts[root];
+				largest = root;
+			}
+		}
+	}
+
+	pool.parallelFor(V, GRAIN, [&](size_t begin, size_t end, size_t) {
+		for (size_t v = begin; v < end; ++v)
+		{
+			if (!g.isOriented() && uf.getRoot((uint32_t)v) == largest)
+				continue;
+
+			for (size_t i = g.edgesBegin(v) + NEIGHBOR_ROUNDS; i < g.edgesEnd(v); ++i)
+				uf.Union((uint32_t)v, (uint32_t)g.target(i));
+		}
+	});
+
+	// Roots are the smallest vertex of their component, so numbering the roots
+	// in vertex order gives the documented labels. Fixed blocks of vertices
+	// count their roots, and a prefix sum over the blocks gives each block its
+	// first label.
+	ConnectedComponents result;
+	result.labels.resize(V);
+
+	size_t blocks = (V + GRAIN - 1) / GRAIN;
+	std::vector<size_t> firstLabel(blocks + 1, 0);
+	pool.parallelFor(blocks, 1, [&](size_t begin, size_t end, size_t) {
+		for (size_t b = begin; b < end; ++b)
+		{
+			for (size_t v = b * GRAIN; v < std::min(V, (b + 1) * GRAIN); ++v)
+			{
+				if (uf.getRoot((uint32_t)v) == v)
+					firstLabel[b + 1]++;
+			}
+		}
+	});
+
+	for (size_t b = 0; b < blocks; ++b)
+		firstLabel[b + 1] += firstLabel[b];
+
+	std::vector<std::atomic<size_t>> sizes(firstLabel[blocks]);
+	pool.parallelFor(blocks, 1, [&](size_t begin, size_t end, size_t) {
+		for (size_t b = begin; b < end; ++b)
+		{
+			size_t label = firstLabel[b];
+			for (size_t v = b * GRAIN; v < std::min(V, (b + 1) * GRAIN); ++v)
+			{
+				if (uf.getRoot((uint32_t)v) == v)
+				{
+					result.labels[v] = label;
+					sizes[label++].store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+	});
+
+	// Roots already hold their labels and are only read here. Sizes are added
+	// up per run of equal labels, so the vertices of the giant component do
+	// not all hit the same counter.
+	pool.parallelFor(V, GRAIN, [&](size_t begin, size_t end, size_t) {
+		size_t runLabel = SIZE_MAX;
+		size_t runLength = 0;
+		for (size_t v = begin; v < end; ++v)
+		{
+			uint32_t root = uf.getRoot((uint32_t)v);
+			if (root != v)
+				result.labels[v] = result.labels[root];
+
+			if (result.labels[v] != runLabel)
+			{
+				if (runLength != 0)
+					sizes[runLabel].fetch_add(runLength, std::memory_order_relaxed);
+				runLabel = result.labels[v];
+				runLength = 0;
+			}
+			++runLength;
+		}
+		if (runLength != 0)
+			sizes[runLabel].fetch_add(runLength, std::memory_order_relaxed);
+	});
+
+	result.sizes.resize(sizes.size());
+	pool.parallelFor(sizes.size(), GRAIN, [&](size_t begin, size_t end, size_t) {
+		for (size_t c = begin; c < end; ++c)
+			result.sizes[c] = sizes[c].load(std::memory_order_relaxed);
+	});
+
+	return result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+// Vertices grouped into levels: level i is order[levelStarts[i]] ..
+// order[levelStarts[i + 1] - 1]. Every edge goes from a lower level to a
+// higher one, so the vertices of one level never depend on each other and can
+// be processed together. The order inside a level is unspecified.
+struct TopoLevels
+{
+	std::vector<size_t> order;
+	std::vector<size_t> levelStarts;
+	bool hasCycle;
+};
+
+// Kahn's algorithm, one level at a time. In-degrees are counted with atomic
+// increments, and every level is expanded across the pool: the thread whose
+// decrement takes a vertex's in-degree to zero is the only one that sees it
+// reach zero, so it alone adds the vertex to the next level. Vertices on a
+// cycle, or reachable from one, never reach zero and are left out of order,
+// which is how cycles are detected. Edges are treated as directed.
+inline TopoLevels parallelTopoSort(const CsrGraph& g, ThreadPool& pool)
+{
+	const size_t GRAIN = 1024;
+	size_t V = g.vertexCount();
+	size_t threads = pool.size();
+
+	std::vector<std::atomic<uint32_t>> inDegree(V);
+	pool.parallelFor(V, GRAIN, [&](size_t begin, size_t end, size_t) {
+		for (size_t v = begin; v < end; ++v)
+			inDegree[v].store(0, std::memory_order_relaxed);
+	});
+
+	pool.parallelFor(V, GRAIN, [&](size_t begin, size_t end, size_t) {
+		for (size_t i = g.edgesBegin(begin); i < g.edgesEnd(end - 1); ++i)
+			inDegree[g.target(i)].fetch_add(1, std::memory_order_relaxed);
+	});
+
+	TopoLevels result;
+	result.order.reserve(V);
+	result.levelStarts.push_back(0);
+
+	std::vector<std::vector<size_t>> found(threads);
+	std::vector<size_t> offsets(threads + 1);
+
+	// Appends the per-thread lists to order as the next level
+	auto appendLevel = [&]() {
+		for (size_t t = 0; t < threads; ++t)
+			offsets[t + 1] = offsets[t] + found[t].size();
+
+		size_t levelStart = result.order.size();
+		result.order.resize(levelStart + offsets.back());
+		pool.parallelFor(threads, 1, [&](size_t begin, size_t end, size_t) {
+			for (size_t t = begin; t < end; ++t)
+			{
+				std::copy(found[t].begin(), found[t].end(), result.order.begin() + levelStart + offsets[t]);
+				found[t].clear();
+			}
+		});
+	};
+
+	pool.parallelFor(V, GRAIN, [&](size_t begin, size_t end, size_t thread) {
+		for (size_t v = begin; v < end; ++v)
+		{
+			if (inDegree[v].load(std::memory_order_relaxed) == 0)
+				found[thread].push_back(v);
+		}
+	});
+	appendLevel();
+
+	while (result.order.size() != result.levelStarts.back())
+	{
+		size_t levelBegin = result.levelStarts.back();
+		size_t levelEnd = result.order.size();
+		result.levelStarts.push_back(levelEnd);
+
+		pool.parallelFor(levelEnd - levelBegin, GRAIN, [&](size_t begin, size_t end, size_t thread) {
+			for (size_t f = levelBegin + begin; f < levelBegin + end; ++f)
+			{
+				size_t u = result.order[f];
+				for (size_t i = g.edgesBegin(u); i < g.edgesEnd(u); ++i)
+				{
+					size_t v = g.target(i);
+					if (inDegree[v].fetch_sub(1, std::memory_order_relaxed) == 1)
+						found[thread].push_back(v);
+				}
+			}
+		});
+		appendLevel();
+	}
+
+	result.hasCycle = result.order.size() != V;
+	return result;
+}
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <string>
+#include "GraphAlgorithms.cpp"
+#include "Benchmark.h"
+
+// Graph::Prim, which uses the indexed heap on sparse graphs and the O(V^2)
+// array scan on dense ones, against CsrGraph::Prim, which pushes every edge
+// into a std::priority_queue and skips the stale entries. Random undirected
+// graphs on V vertices (3000 unless given on the command line) are swept from
+// density 0.001 to the complete graph; each pair of vertices is an edge with
+// probability density, and a path through all vertices keeps the graph
+// connected. The entries column is adjacency entries / V^2, which Prim
+// compares with its switch-over point.
+
+int main(int argc, char* argv[])
+{
+	size_t V = argc > 1 ? std::stoul(argv[1]) : 3000;
+	std::mt19937 random(5);
+	std::uniform_int_distribution<int> anyWeight(1, 1000000);
+	std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+	std::cout << "density\tentries\tGraph::Prim ms\tCsrGraph::Prim ms\tspeedup" << std::endl;
+	for (double density : { 0.001, 0.01, 0.05, 0.1, 0.25, 0.4, 0.5, 0.75, 1.0 })
+	{
+		Graph g(V, false);
+		size_t entries = 0;
+		for (size_t i = 0; i < V; ++i)
+		{
+			for (size_t j = i + 1; j < V; ++j)
+			{
+				if (j == i + 1 || coin(random) < density)
+				{
+					g.addEdge(i, j, anyWeight(random));
+					entries += 2;
+				}
+			}
+		}
+		CsrGraph csr = g.toCsr();
+
+		MST indexed;
+		MST lazy;
+		double indexedTime = timeSeconds([&] { indexed = g.Prim(); });
+		double lazyTime = timeSeconds([&] { lazy = csr.Prim(); });
+
+		std::cout << density << "\t" << (double)entries / ((double)V * V) << "\t" << indexedTime * 1e3 << "\t\t"
+			<< lazyTime * 1e3 << "\t\t\t" << lazyTime / indexedTime << "x"
+			<< (indexed.sumOfWeights == lazy.sumOfWeights ? "" : "\tMISMATCH") << std::endl;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "GraphTypes.h"
+#include "ThreadPool.h"
+#include "TraversalWorkspace.h"
+
+struct ShortestPathQuery
+{
+	size_t source;
+	size_t target;
+};
+
+// Answers many independent shortest-distance queries against one graph.
+// Queries are grouped by source so that each distinct source costs a single
+// search that stops once all of its targets are settled, and the groups are
+// spread over the pool. Every thread keeps its own TraversalWorkspace and
+// scratch arrays across run() calls, so a burst of queries allocates nothing
+// proportional to the graph. GraphType must provide
+// dijkstra_targets(start, targets, count, distances, workspace).
+template<typename GraphType>
+class QueryBatch
+{
+public:
+
+	QueryBatch(const GraphType& graph, ThreadPool& pool);
+
+	// results[i] receives the distance for queries[i], UNREACHABLE if there is
+	// no path. results must have room for count entries.
+	void run(const ShortestPathQuery* queries, size_t count, size_t* results);
+
+private:
+
+	struct ThreadScratch
+	{
+		TraversalWorkspace workspace;
+		std::vector<size_t> targets;
+		std::vector<size_t> distances;
+	};
+
+	const GraphType& graph;
+	ThreadPool& pool;
+	std::vector<ThreadScratch> scratch;
+	std::vector<size_t> order;
+	std::vector<size_t> groupStarts;
+};
+
+template<typename GraphType>
+QueryBatch<GraphType>::QueryBatch(const GraphType& graph, ThreadPool& pool)
+	: graph(graph), pool(pool), scratch(pool.size()) {}
+
+template<typename GraphType>
+void QueryBatch<GraphType>::run(const ShortestPathQuery* queries, size_t count, size_t* results)
+{
+	order.resize(count);
+	for (size_t i = 0; i < count; ++i)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [queries](size_t lhs, size_t rhs) {
+		return queries[lhs].source < queries[rhs].source;
+		});
+
+	groupStarts.clear();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (i == 0 || queries[order[i]].source != queries[order[i - 1]].source)
+			groupStarts.push_back(i);
+	}
+	groupStarts.push_back(count);
+
+	pool.parallelFor(groupStarts.size() - 1, 1, [&](size_t begin, size_t end, size_t thread) {
+		ThreadScratch& local = scratch[thread];
+		for (size_t group = begin; group < end; ++group)
+		{
+			size_t first = groupStarts[group];
+			size_t last = groupStarts[group + 1];
+
+			local.targets.clear();
+			for (size_t i = first; i < last; ++i)
+				local.targets.push_back(queries[order[i]].target);
+			local.distances.resize(last - first);
+
+			graph.dijkstra_targets(queries[order[first]].source, local.targets.data(), local.targets.size(),
+				local.distances.data(), local.workspace);
+
+			for (size_t i = first; i < last; ++i)
+				results[order[i]] = local.distances[i - first];
+		}
+	});
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include "GraphTypes.h"
+
+// Synthetic R-MAT edge list (Chakrabarti, Zhan and Faloutsos) on 2^scale
+// vertices with edgeFactor * 2^scale edges and weights uniform in
+// [1, maxWeight]. Every edge picks one quadrant of the adjacency matrix per
+// bit with the Graph500 probabilities, which gives the skewed degrees and the
+// single giant component of real networks. Vertex ids are then shuffled so
+// that the high degree vertices are not all at the front. Self loops and
+// repeated edges are kept, as in Graph500.
+inline std::vector<Edge> rmatEdges(size_t scale, size_t edgeFactor, int maxWeight, uint64_t seed)
+{
+	const double A = 0.57;
+	const double B = 0.19;
+	const double C = 0.19;
+
+	size_t V = (size_t)1 << scale;
+	std::mt19937_64 random(seed);
+	std::uniform_real_distribution<double> quadrant(0.0, 1.0);
+	std::uniform_int_distribution<int> anyWeight(1, maxWeight);
+
+	std::vector<size_t> permutation(V);
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::shuffle(permutation.begin(), permutation.end(), random);
+
+	std::vector<Edge> edges(edgeFactor * V);
+	for (Edge& e : edges)
+	{
+		size_t start = 0;
+		size_t end = 0;
+		for (size_t bit = 0; bit < scale; ++bit)
+		{
+			double p = quadrant(random);
+			start = 2 * start + (p >= A + B);
+			end = 2 * end + ((p >= A && p < A + B) || p >= A + B + C);
+		}
+		e = Edge(permutation[start], permutation[end], anyWeight(random));
+	}
+
+	return edges;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <atomic>
+#include <algorithm>
+
+// Fixed set of worker threads for data-parallel loops. The thread that calls
+// parallelFor takes part in the loop as thread 0, so a pool of size 1 runs
+// everything inline. parallelFor is not reentrant.
+class ThreadPool
+{
+public:
+
+	explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+	ThreadPool(const ThreadPool& other) = delete;
+	ThreadPool& operator=(const ThreadPool& other) = delete;
+	~ThreadPool();
+
+	size_t size() const;
+
+	// Calls fn(begin, end, thread) on chunks of at most grain indices until
+	// [0, n) is covered, and returns when all chunks are done. thread is in
+	// [0, size()) and can index per-thread scratch space. If fn throws, no
+	// further chunks are started, the chunks already running are waited for,
+	// and the first exception is rethrown on the calling thread.
+	template<typename Function>
+	void parallelFor(size_t n, size_t grain, Function fn);
+
+private:
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	std::function<void(size_t)> job;
+	size_t generation = 0;
+	size_t pending = 0;
+	bool stopping = false;
+
+	void work(size_t thread);
+};
+
+inline ThreadPool::ThreadPool(size_t threadCount)
+{
+	for (size_t i = 1; i < std::max<size_t>(threadCount, 1); ++i)
+		workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+inline ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+inline size_t ThreadPool::size() const
+{
+	return workers.size() + 1;
+}
+
+inline void ThreadPool::work(size_t thread)
+{
+	size_t seen = 0;
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		wake.wait(lock, [&] { return stopping || generation != seen; });
+		if (stopping)
+			return;
+
+		seen = generation;
+		lock.unlock();
+
+		job(thread);
+
+		lock.lock();
+		if (--pending == 0)
+			done.notify_one();
+	}
+}
+
+template<typename Function>
+void ThreadPool::parallelFor(size_t n, size_t grain, Function fn)
+{
+	if (n == 0)
+		return;
+
+	grain = std::max<size_t>(grain, 1);
+	if (workers.empty() || n <= grain)
+	{
+		for (size_t begin = 0; begin < n; begin += grain)
+			fn(begin, std::min(n, begin + grain), 0);
+		return;
+	}
+
+	// The calling thread's part runs under the same catch, so fn's exceptions
+	// never unwind this frame while workers still use it
+	std::atomic<size_t> next(0);
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	auto body = [&](size_t thread) {
+		try
+		{
+			for (size_t begin = next.fetch_add(grain); begin < n; begin = next.fetch_add(grain))
+				fn(begin, std::min(n, begin + grain), thread);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (!error)
+				error = std::current_exception();
+			next.store(n);
+		}
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = body;
+		pending = workers.size();
+		++generation;
+	}
+	wake.notify_all();
+
+	body(0);
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&] { return pending == 0; });
+	}
+
+	if (error)
+		std::rethrow_exception(error);
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include "GraphTypes.h"
+
+// Scratch state for graph searches that can be reused across queries.
+// Instead of clearing the per-vertex arrays before every query, each entry
+// carries the number of the query that last wrote it; entries from older
+// queries read as unvisited. Starting a query costs O(1) plus the number of
+// buckets the previous query asked for, so a search costs O(vertices it
+// touches) even on a huge graph.
+class TraversalWorkspace
+{
+public:
+
+	explicit TraversalWorkspace(size_t vertexCount = 0);
+
+	// Starts a new query on a graph with vertexCount vertices
+	void reset(size_t vertexCount);
+
+	bool isVisited(size_t v) const;
+	void visit(size_t v);
+
+	// UNREACHABLE for vertices not visited in this query
+	size_t distance(size_t v) const;
+	size_t parent(size_t v) const;
+
+	// Also marks v as visited
+	void setDistance(size_t v, size_t dist, size_t parent);
+
+	// Buffers that reset() empties but keeps the capacity of
+	std::vector<size_t>& frontier();
+	std::vector<std::pair<size_t, size_t>>& heap();
+
+	// At least count buckets, all of them empty at the start of a query. Only
+	// the first count may be used; reset() empties no others
+	std::vector<std::vector<std::pair<size_t, size_t>>>& buckets(size_t count);
+
+private:
+
+	std::vector<uint32_t> stamps;
+	std::vector<size_t> distances;
+	std::vector<size_t> parents;
+	std::vector<size_t> frontierBuffer;
+	std::vector<std::pair<size_t, size_t>> heapBuffer;
+	std::vector<std::vector<std::pair<size_t, size_t>>> bucketBuffers;
+	size_t bucketsInUse = 0; // largest count passed to buckets() since the last reset
+	uint32_t epoch = 1;
+};
+
+inline TraversalWorkspace::TraversalWorkspace(size_t vertexCount)
+	: stamps(vertexCount, 0), distances(vertexCount), parents(vertexCount) {}
+
+inline void TraversalWorkspace::reset(size_t vertexCount)
+{
+	if (stamps.size() < vertexCount)
+	{
+		stamps.resize(vertexCount, 0);
+		distances.resize(vertexCount);
+		parents.resize(vertexCount);
+	}
+
+	// After 2^32 queries the stamps wrap around and would alias old ones
+	if (++epoch == 0)
+	{
+		std::fill(stamps.begin(), stamps.end(), 0);
+		epoch = 1;
+	}
+
+	frontierBuffer.clear();
+	heapBuffer.clear();
+	for (size_t i = 0; i < bucketsInUse; ++i)
+		bucketBuffers[i].clear();
+	bucketsInUse = 0;
+}
+
+inline bool TraversalWorkspace::isVisited(size_t v) const
+{
+	return stamps[v] == epoch;
+}
+
+inline void TraversalWorkspace::visit(size_t v)
+{
+	setDistance(v, UNREACHABLE, UNREACHABLE);
+}
+
+inline size_t TraversalWorkspace::distance(size_t v) const
+{
+	return stamps[v] == epoch ? distances[v] : UNREACHABLE;
+}
+
+inline size_t TraversalWorkspace::parent(size_t v) const
+{
+	return stamps[v] == epoch ? parents[v] : UNREACHABLE;
+}
+
+inline void TraversalWorkspace::setDistance(size_t v, size_t dist, size_t parent)
+{
+	stamps[v] = epoch;
+	distances[v] = dist;
+	parents[v] = parent;
+}
+
+inline std::vector<size_t>& TraversalWorkspace::frontier()
+{
+	return frontierBuffer;
+}
+
+inline std::vector<std::pair<size_t, size_t>>& TraversalWorkspace::heap()
+{
+	return heapBuffer;
+}
+
+inline std::vector<std::vector<std::pair<size_t, size_t>>>& TraversalWorkspace::buckets(size_t count)
+{
+	if (bucketBuffers.size() < count)
+		bucketBuffers.resize(count);
+	bucketsInUse = std::max(bucketsInUse, count);
+	return bucketBuffers;
+}
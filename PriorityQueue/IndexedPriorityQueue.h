@@ -0,0 +1,181 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <cstdint>
+
+// Binary heap over the indices 0 .. capacity - 1, each with a key, where the
+// key of an index already in the queue can be lowered in place. Every index is
+// in the queue at most once, so the heap never grows past capacity, and the
+// top is the index whose key compares first.
+template <typename Key, typename Compare = std::less<Key>>
+class IndexedPriorityQueue
+{
+	static constexpr size_t NOT_IN_QUEUE = SIZE_MAX;
+
+	std::vector<size_t> heap;      // indices in heap order
+	std::vector<size_t> positions; // where each index sits in heap
+	std::vector<Key> keys;
+	Compare comp;
+
+	static size_t parent(size_t i);
+	bool before(size_t lhs, size_t rhs) const;
+	void place(size_t pos, size_t index);
+	void siftUp(size_t pos);
+	void siftDown(size_t pos);
+
+public:
+
+	explicit IndexedPriorityQueue(size_t capacity, const Compare& comparator = Compare());
+
+	bool empty() const;
+	size_t size() const;
+	bool contains(size_t index) const;
+	const Key& keyOf(size_t index) const;
+
+	size_t peekIndex() const;
+	const Key& peekKey() const;
+	void pop();
+
+	void insert(size_t index, const Key& key);
+	// key must not come after the current key of index
+	void decreaseKey(size_t index, const Key& key);
+};
+
+template <typename Key, typename Compare>
+size_t IndexedPriorityQueue<Key, Compare>::parent(size_t i)
+{
+	return (i - 1) / 2;
+}
+
+template <typename Key, typename Compare>
+bool IndexedPriorityQueue<Key, Compare>::before(size_t lhs, size_t rhs) const
+{
+	return comp(keys[heap[lhs]], keys[heap[rhs]]);
+}
+
+template <typename Key, typename Compare>
+void IndexedPriorityQueue<Key, Compare>::place(size_t pos, size_t index)
+{
+	heap[pos] = index;
+	positions[index] = pos;
+}
+
+// Moves the hole instead of swapping, so each level costs one write
+template <typename Key, typename Compare>
+void IndexedPriorityQueue<Key, Compare>::siftUp(size_t pos)
+{
+	size_t index = heap[pos];
+	while (pos > 0 && comp(keys[index], keys[heap[parent(pos)]]))
+	{
+		place(pos, heap[parent(pos)]);
+		pos = parent(pos);
+	}
+	place(pos, index);
+}
+
+template <typename Key, typename Compare>
+void IndexedPriorityQueue<Key, Compare>::siftDown(size_t pos)
+{
+	size_t index = heap[pos];
+	while (true)
+	{
+		size_t child = 2 * pos + 1;
+		if (child >= heap.size())
+			break;
+		if (child + 1 < heap.size() && before(child + 1, child))
+			++child;
+		if (!comp(keys[heap[child]], keys[index]))
+			break;
+
+		place(pos, heap[child]);
+		pos = child;
+	}
+	place(pos, index);
+}
+
+template <typename Key, typename Compare>
+IndexedPriorityQueue<Key, Compare>::IndexedPriorityQueue(size_t capacity, const Compare& comparator)
+	: positions(capacity, NOT_IN_QUEUE), keys(capacity), comp(comparator)
+{
+	heap.reserve(capacity);
+}
+
+template <typename Key, typename Compare>
+bool IndexedPriorityQueue<Key, Compare>::empty() const
+{
+	return heap.empty();
+}
+
+template <typename Key, typename Compare>
+size_t IndexedPriorityQueue<Key, Compare>::size() const
+{
+	return heap.size();
+}
+
+template <typename Key, typename Compare>
+bool IndexedPriorityQueue<Key, Compare>::contains(size_t index) const
+{
+	return positions[index] != NOT_IN_QUEUE;
+}
+
+template <typename Key, typename Compare>
+const Key& IndexedPriorityQueue<Key, Compare>::keyOf(size_t index) const
+{
+	if (!contains(index))
+		throw std::runtime_error("Index is not in the queue!");
+	return keys[index];
+}
+
+template <typename Key, typename Compare>
+size_t IndexedPriorityQueue<Key, Compare>::peekIndex() const
+{
+	if (empty())
+		throw std::runtime_error("Empty queue");
+	return heap[0];
+}
+
+template <typename Key, typename Compare>
+const Key& IndexedPriorityQueue<Key, Compare>::peekKey() const
+{
+	return keys[peekIndex()];
+}
+
+template <typename Key, typename Compare>
+void IndexedPriorityQueue<Key, Compare>::pop()
+{
+	if (empty())
+		throw std::runtime_error("Empty queue");
+
+	positions[heap[0]] = NOT_IN_QUEUE;
+	size_t last = heap.back();
+	heap.pop_back();
+
+	if (!heap.empty())
+	{
+		place(0, last);
+		siftDown(0);
+	}
+}
+
+template <typename Key, typename Compare>
+void IndexedPriorityQueue<Key, Compare>::insert(size_t index, const Key& key)
+{
+	if (contains(index))
+		throw std::runtime_error("Index is already in the queue!");
+
+	keys[index] = key;
+	heap.push_back(index);
+	positions[index] = heap.size() - 1;
+	siftUp(heap.size() - 1);
+}
+
+template <typename Key, typename Compare>
+void IndexedPriorityQueue<Key, Compare>::decreaseKey(size_t index, const Key& key)
+{
+	if (!contains(index))
+		throw std::runtime_error("Index is not in the queue!");
+
+	keys[index] = key;
+	siftUp(positions[index]);
+}
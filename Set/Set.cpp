@@ -4,6 +4,8 @@
 template<typename T, typename Compare = std::less<T>>
 class Set
 {
+	struct Node;
+
 public:
 
 	Set() = default;
@@ -144,7 +146,7 @@ bool Set<T, Compare>::contains(const T& el) const
 template<typename T, typename Compare>
 typename Set<T, Compare>::Node** Set<T, Compare>::findMinNode(Node** root)
 {
-	Node** current = &root;
+	Node** current = root;
 
 	while ((*current)->left)
 	{
@@ -161,9 +163,9 @@ bool Set<T, Compare>::remove(const T& el)
 
 	while (*current)
 	{
-		if (comp(data, (*current)->data))
+		if (comp(el, (*current)->data))
 			current = &(*current)->left;
-		else if (comp((*current)->data, data))
+		else if (comp((*current)->data, el))
 			current = &(*current)->right;
 		else
 			break;
@@ -214,7 +216,7 @@ typename Set<T, Compare>::Node* Set<T, Compare>::copy(Node* current)
 		return nullptr;
 
 	Node* res = new Node(current->data);
-	res->right = copy(current->left);
+	res->left = copy(current->left);
 	res->right = copy(current->right);
 	return res;
 }
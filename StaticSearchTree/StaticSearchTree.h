@@ -0,0 +1,233 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <type_traits>
+#include "../Set/Set.cpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STATIC_SEARCH_TREE_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define STATIC_SEARCH_TREE_PREFETCH(address) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#else
+#define STATIC_SEARCH_TREE_PREFETCH(address) __builtin_prefetch(address)
+#endif
+
+enum class SearchLayout
+{
+	Eytzinger, // binary tree stored in BFS order
+	BTree      // S-tree: blocks of BLOCK_SIZE keys with BLOCK_SIZE + 1 implicit children
+};
+
+// Immutable search index over a sorted sequence. Both layouts place the keys that
+// a search visits next to each other, so a lookup touches a handful of cache lines
+// instead of one per comparison.
+template<typename T, typename Compare = std::less<T>>
+class StaticSearchTree
+{
+public:
+
+	static const size_t BLOCK_SIZE = 16;
+
+	explicit StaticSearchTree(const std::vector<T>& sorted, SearchLayout layout = SearchLayout::Eytzinger, const Compare& comparator = Compare());
+	explicit StaticSearchTree(const Set<T, Compare>& set, SearchLayout layout = SearchLayout::Eytzinger, const Compare& comparator = Compare());
+
+	// Returns the smallest key that is not less than el, or nullptr if there is none.
+	const T* lower_bound(const T& el) const;
+	bool contains(const T& el) const;
+
+	size_t getSize() const;
+	bool isEmpty() const;
+
+private:
+
+	std::vector<T> tree;
+	size_t size = 0;
+	size_t blockCount = 0;
+	SearchLayout layout;
+	Compare comp;
+
+	void build(const std::vector<T>& sorted);
+	void buildEytzinger(const std::vector<T>& sorted, size_t& next, size_t k);
+	void buildBTree(const std::vector<T>& sorted, size_t& next, size_t k);
+
+	const T* eytzingerLowerBound(const T& el) const;
+	const T* bTreeLowerBound(const T& el) const;
+	size_t rankInBlock(const T* block, const T& el) const;
+
+	static size_t child(size_t block, size_t i)
+	{
+		return block * (BLOCK_SIZE + 1) + i + 1;
+	}
+};
+
+template<typename T, typename Compare>
+StaticSearchTree<T, Compare>::StaticSearchTree(const std::vector<T>& sorted, SearchLayout layout, const Compare& comparator)
+	: layout(layout), comp(comparator)
+{
+	build(sorted);
+}
+
+template<typename T, typename Compare>
+StaticSearchTree<T, Compare>::StaticSearchTree(const Set<T, Compare>& set, SearchLayout layout, const Compare& comparator)
+	: layout(layout), comp(comparator)
+{
+	std::vector<T> sorted;
+	sorted.reserve(set.getSize());
+	for (auto it = set.cbegin(); it != set.cend(); ++it)
+		sorted.push_back(*it);
+
+	build(sorted);
+}
+
+template<typename T, typename Compare>
+void StaticSearchTree<T, Compare>::build(const std::vector<T>& sorted)
+{
+	size = sorted.size();
+	if (size == 0)
+		return;
+
+	size_t next = 0;
+	if (layout == SearchLayout::Eytzinger)
+	{
+		// Index 0 is unused so that the children of k are 2k and 2k + 1.
+		tree.resize(size + 1);
+		buildEytzinger(sorted, next, 1);
+	}
+	else
+	{
+		blockCount = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		tree.resize(blockCount * BLOCK_SIZE);
+		buildBTree(sorted, next, 0);
+	}
+}
+
+template<typename T, typename Compare>
+void StaticSearchTree<T, Compare>::buildEytzinger(const std::vector<T>& sorted, size_t& next, size_t k)
+{
+	if (k > size)
+		return;
+
+	buildEytzinger(sorted, next, 2 * k);
+	tree[k] = sorted[next++];
+	buildEytzinger(sorted, next, 2 * k + 1);
+}
+
+// The last block is padded with copies of the largest key. They never compare
+// less than a key that is in range, so they do not change any search result.
+template<typename T, typename Compare>
+void StaticSearchTree<T, Compare>::buildBTree(const std::vector<T>& sorted, size_t& next, size_t k)
+{
+	if (k >= blockCount)
+		return;
+
+	for (size_t i = 0; i < BLOCK_SIZE; ++i)
+	{
+		buildBTree(sorted, next, child(k, i));
+		tree[k * BLOCK_SIZE + i] = next < size ? sorted[next++] : sorted[size - 1];
+	}
+	buildBTree(sorted, next, child(k, BLOCK_SIZE));
+}
+
+template<typename T, typename Compare>
+const T* StaticSearchTree<T, Compare>::lower_bound(const T& el) const
+{
+	if (size == 0)
+		return nullptr;
+
+	return layout == SearchLayout::Eytzinger ? eytzingerLowerBound(el) : bTreeLowerBound(el);
+}
+
+// Descends without branching on the comparison and prefetches the cache line
+// holding the descendants of k a few levels down, so the memory latency of the
+// next levels overlaps with the comparisons on the current one.
+template<typename T, typename Compare>
+const T* StaticSearchTree<T, Compare>::eytzingerLowerBound(const T& el) const
+{
+	const size_t prefetchStride = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+	const T* base = tree.data();
+
+	size_t k = 1;
+	while (k <= size)
+	{
+		STATIC_SEARCH_TREE_PREFETCH(base + (k * prefetchStride < tree.size() ? k * prefetchStride : 0));
+		k = 2 * k + comp(base[k], el);
+	}
+
+	// Every right turn appended a 1 bit; dropping the trailing ones and the last
+	// left turn gives the node where the search last went left.
+	while (k & 1)
+		k >>= 1;
+	k >>= 1;
+
+	return k == 0 ? nullptr : base + k;
+}
+
+template<typename T, typename Compare>
+const T* StaticSearchTree<T, Compare>::bTreeLowerBound(const T& el) const
+{
+	const T* result = nullptr;
+
+	size_t k = 0;
+	while (k < blockCount)
+	{
+		const T* block = tree.data() + k * BLOCK_SIZE;
+		size_t i = rankInBlock(block, el);
+		if (i < BLOCK_SIZE)
+			result = block + i;
+		k = child(k, i);
+	}
+
+	return result;
+}
+
+// Number of keys in the block that are less than el.
+template<typename T, typename Compare>
+size_t StaticSearchTree<T, Compare>::rankInBlock(const T* block, const T& el) const
+{
+#ifdef STATIC_SEARCH_TREE_SSE2
+	if constexpr (std::is_same<T, int32_t>::value && std::is_same<Compare, std::less<T>>::value)
+	{
+		__m128i key = _mm_set1_epi32(el);
+		int mask = 0;
+		for (size_t i = 0; i < BLOCK_SIZE; i += 4)
+		{
+			__m128i lanes = _mm_loadu_si128((const __m128i*)(block + i));
+			mask |= _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key, lanes))) << i;
+		}
+
+		size_t count = 0;
+		for (; mask; mask &= mask - 1)
+			++count;
+		return count;
+	}
+#endif
+
+	size_t count = 0;
+	for (size_t i = 0; i < BLOCK_SIZE; ++i)
+		count += comp(block[i], el);
+	return count;
+}
+
+template<typename T, typename Compare>
+bool StaticSearchTree<T, Compare>::contains(const T& el) const
+{
+	const T* found = lower_bound(el);
+	return found && !comp(el, *found);
+}
+
+template<typename T, typename Compare>
+size_t StaticSearchTree<T, Compare>::getSize() const
+{
+	return size;
+}
+
+template<typename T, typename Compare>
+bool StaticSearchTree<T, Compare>::isEmpty() const
+{
+	return size == 0;
+}
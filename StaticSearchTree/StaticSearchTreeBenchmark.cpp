@@ -0,0 +1,69 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <string>
+#include "StaticSearchTree.h"
+#include "../Graph/Benchmark.h"
+
+// Membership tests on n keys (10M unless given on the command line):
+// Set::contains against lower_bound on both StaticSearchTree layouts built
+// from that Set. The keys 0, 2, 4, ... go into the Set in random order, so
+// its unbalanced tree is about 2 ln n deep on average, and about half of the
+// LOOKUPS random probes are present.
+
+const size_t LOOKUPS = 1000000;
+
+int main(int argc, char* argv[])
+{
+	size_t n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+	std::mt19937 random(2024);
+
+	std::vector<int> keys(n);
+	for (size_t i = 0; i < n; ++i)
+		keys[i] = (int)(2 * i);
+	std::shuffle(keys.begin(), keys.end(), random);
+
+	std::vector<int> probes(LOOKUPS);
+	std::uniform_int_distribution<int> anyKey(0, (int)(2 * n));
+	for (int& probe : probes)
+		probe = anyKey(random);
+
+	Set<int> set;
+	for (int key : keys)
+		set.insert(key);
+
+	StaticSearchTree<int> eytzinger(set, SearchLayout::Eytzinger);
+	StaticSearchTree<int> bTree(set, SearchLayout::BTree);
+
+	size_t setFound = 0;
+	double setTime = timeSeconds([&] {
+		for (int probe : probes)
+			setFound += set.contains(probe);
+	});
+
+	// A lower_bound equal to the probe means the probe is present
+	auto timeTree = [&](const StaticSearchTree<int>& tree, size_t& found) {
+		return timeSeconds([&] {
+			for (int probe : probes)
+			{
+				const int* bound = tree.lower_bound(probe);
+				found += bound && *bound == probe;
+			}
+		});
+	};
+
+	size_t eytzingerFound = 0;
+	size_t bTreeFound = 0;
+	double eytzingerTime = timeTree(eytzinger, eytzingerFound);
+	double bTreeTime = timeTree(bTree, bTreeFound);
+
+	std::cout << n << " keys, " << LOOKUPS << " lookups, " << setFound << " found";
+	if (eytzingerFound != setFound || bTreeFound != setFound)
+		std::cout << " (MISMATCH)";
+	std::cout << std::endl;
+
+	std::cout << "Set::contains\t" << setTime * 1e9 / LOOKUPS << " ns" << std::endl;
+	std::cout << "Eytzinger\t" << eytzingerTime * 1e9 / LOOKUPS << " ns\t" << setTime / eytzingerTime << "x" << std::endl;
+	std::cout << "S-tree\t\t" << bTreeTime * 1e9 / LOOKUPS << " ns\t" << setTime / bTreeTime << "x" << std::endl;
+}